@@ -0,0 +1,121 @@
+/*
+ * Cost of resolving an event's native handle to a window ID with
+ * 1 to 1000 windows: the hashed window index against the linear scan over
+ * the window array it replaced. Handles are synthetic, so no display is
+ * needed. Exits non-zero if a lookup returns the wrong window.
+ *
+ * Usage: glps_window_index_bench [max_windows] [lookups]
+ */
+
+#include "glps_window_index.h"
+#include "glps_latency.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t WINDOW_COUNTS[] = {1, 10, 100, 1000};
+
+// XIDs of one client share the high bits and step through the low ones.
+static uintptr_t __handle(size_t i)
+{
+    return (uintptr_t)0x3a00001 + (uintptr_t)i * 0x200000;
+}
+
+// Smallest step past count / 2 that shares no factor with count, so the
+// scattered walk below still visits every window.
+static size_t __coprime_step(size_t count)
+{
+    for (size_t step = count / 2 + 1;; ++step)
+    {
+        size_t a = step, b = count;
+        while (b != 0)
+        {
+            size_t r = a % b;
+            a = b;
+            b = r;
+        }
+        if (a == 1) return step;
+    }
+}
+
+static ssize_t __linear_find(const uintptr_t *handles, size_t count, uintptr_t key)
+{
+    for (size_t i = 0; i < count; ++i)
+        if (handles[i] == key) return (ssize_t)i;
+    return -1;
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_windows = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000;
+    size_t lookups = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000;
+    if (max_windows == 0 || lookups == 0)
+    {
+        fprintf(stderr, "usage: %s [max_windows] [lookups]\n", argv[0]);
+        return 2;
+    }
+
+    uintptr_t *handles = malloc(max_windows * sizeof(*handles));
+    if (handles == NULL) return 1;
+
+    glps_WindowManager wm;
+    memset(&wm, 0, sizeof(wm));
+
+    printf("%8s %14s %14s %14s %14s\n", "windows", "insert ns", "index ns", "scan ns", "remove ns");
+
+    int failures = 0;
+    for (size_t c = 0; c < sizeof(WINDOW_COUNTS) / sizeof(WINDOW_COUNTS[0]); ++c)
+    {
+        size_t count = WINDOW_COUNTS[c];
+        if (count > max_windows) break;
+
+        uint64_t start = glps_latency_now_ns();
+        for (size_t i = 0; i < count; ++i)
+        {
+            handles[i] = __handle(i);
+            if (!glps_window_index_add(&wm, handles[i], i)) failures++;
+        }
+        uint64_t insert_ns = glps_latency_now_ns() - start;
+
+        // Walk the windows in a scattered order, as pointer motion across
+        // windows would, so neither side benefits from a hot first entry.
+        size_t step = __coprime_step(count);
+        ssize_t checksum = 0;
+
+        start = glps_latency_now_ns();
+        for (size_t n = 0, i = 0; n < lookups; ++n, i = (i + step) % count)
+        {
+            ssize_t window_id = glps_window_index_find(&wm, handles[i]);
+            if (window_id != (ssize_t)i) failures++;
+            checksum += window_id;
+        }
+        uint64_t index_ns = glps_latency_now_ns() - start;
+
+        start = glps_latency_now_ns();
+        for (size_t n = 0, i = 0; n < lookups; ++n, i = (i + step) % count)
+            checksum -= __linear_find(handles, count, handles[i]);
+        uint64_t scan_ns = glps_latency_now_ns() - start;
+
+        start = glps_latency_now_ns();
+        for (size_t i = 0; i < count; ++i)
+            glps_window_index_remove(&wm, handles[i]);
+        uint64_t remove_ns = glps_latency_now_ns() - start;
+
+        if (checksum != 0 || glps_window_index_find(&wm, handles[0]) != -1) failures++;
+
+        printf("%8zu %14.1f %14.1f %14.1f %14.1f\n", count,
+               (double)insert_ns / count, (double)index_ns / lookups,
+               (double)scan_ns / lookups, (double)remove_ns / count);
+    }
+
+    glps_window_index_clear(&wm);
+    free(handles);
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d lookups returned the wrong window\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+#ifndef GLPS_LOOP_H
+#define GLPS_LOOP_H
+
+/**
+ * @file glps_loop.h
+ * @brief Optional epoll reactor for Linux.
+ *
+ * A glps_loop waits on the window manager's display connection, any number
+ * of timers and arbitrary user file descriptors with a single epoll_wait, so
+ * an idle application uses no CPU. Timers are backed by timerfd and fire the
+ * same timer_callback type as glps_timer. Everything runs on the thread that
+ * calls glps_loop_run(); only glps_loop_quit() may be called from elsewhere.
+ */
+
+#include "glps_common.h"
+#include "glps_timer.h"
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+
+#define GLPS_LOOP_READABLE 0x1u
+#define GLPS_LOOP_WRITABLE 0x2u
+#define GLPS_LOOP_HANGUP 0x4u /**< Error or hang-up; always reported. */
+
+typedef struct glps_loop glps_loop;
+
+/**
+ * @brief Callback for a user file descriptor.
+ *
+ * @param fd The ready descriptor.
+ * @param events Mask of GLPS_LOOP_* flags that are ready.
+ * @param arg User argument given to glps_loop_add_fd().
+ */
+typedef void (*glps_loop_fd_callback)(int fd, uint32_t events, void *arg);
+
+/**
+ * @brief Creates a loop.
+ *
+ * @param wm Window manager whose events the loop dispatches, or NULL for a
+ *           loop that only serves timers and user descriptors.
+ * @return Pointer to the loop, or NULL on failure.
+ */
+glps_loop *glps_loop_create(glps_WindowManager *wm);
+
+/**
+ * @brief Destroys a loop and closes its timers. User descriptors are left open.
+ *
+ * @param loop Pointer to the loop.
+ */
+void glps_loop_destroy(glps_loop *loop);
+
+/**
+ * @brief Adds a timer.
+ *
+ * @param loop Pointer to the loop.
+ * @param interval_ns Time until the first expiration, and the period if repeating.
+ * @param repeat True to fire every interval_ns, false to fire once.
+ * @param callback Function called on expiration, once per elapsed period.
+ * @param arg Argument passed to the callback.
+ * @return Timer ID, or -1 on failure.
+ */
+int glps_loop_add_timer(glps_loop *loop, uint64_t interval_ns, bool repeat,
+                        timer_callback callback, void *arg);
+
+/**
+ * @brief Removes a timer. Safe to call from the timer's own callback.
+ *
+ * @param loop Pointer to the loop.
+ * @param timer_id ID returned by glps_loop_add_timer().
+ */
+void glps_loop_remove_timer(glps_loop *loop, int timer_id);
+
+/**
+ * @brief Watches a user file descriptor.
+ *
+ * @param loop Pointer to the loop.
+ * @param fd Descriptor to watch. The loop does not take ownership.
+ * @param events Mask of GLPS_LOOP_READABLE and/or GLPS_LOOP_WRITABLE.
+ * @param callback Function called when the descriptor is ready.
+ * @param arg Argument passed to the callback.
+ * @return True on success, false otherwise.
+ */
+bool glps_loop_add_fd(glps_loop *loop, int fd, uint32_t events,
+                      glps_loop_fd_callback callback, void *arg);
+
+/**
+ * @brief Stops watching a user file descriptor. Safe to call from any callback.
+ *
+ * @param loop Pointer to the loop.
+ * @param fd Descriptor passed to glps_loop_add_fd().
+ */
+void glps_loop_remove_fd(glps_loop *loop, int fd);
+
+/**
+ * @brief Waits for at most timeout_ns and dispatches everything that is ready.
+ *
+ * The wait also ends in time for the frames the window manager schedules
+ * itself, see glps_wm_next_timeout_ns().
+ *
+ * @param loop Pointer to the loop.
+ * @param timeout_ns Maximum time to sleep; 0 polls, negative waits forever.
+ * @return True if the loop should stop (glps_loop_quit() was called or the
+ *         window manager should close), false otherwise.
+ */
+bool glps_loop_run_once(glps_loop *loop, int64_t timeout_ns);
+
+/**
+ * @brief Runs until glps_loop_run_once() reports that the loop should stop.
+ *
+ * @param loop Pointer to the loop.
+ */
+void glps_loop_run(glps_loop *loop);
+
+/**
+ * @brief Makes glps_loop_run() return. Safe to call from any thread.
+ *
+ * @param loop Pointer to the loop.
+ */
+void glps_loop_quit(glps_loop *loop);
+
+#endif
+
+#endif // GLPS_LOOP_H
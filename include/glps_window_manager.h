@@ -15,10 +15,34 @@
 /**
  * @brief Initializes the GLPS Window Manager.
  *
+ * On Linux, falls back to the headless backend (see glps_wm_init_headless())
+ * when no display server is reachable, and uses it right away when the
+ * GLPS_HEADLESS environment variable is set to anything but 0.
+ *
  * @return Pointer to the initialized GLPS Window Manager instance.
  */
 glps_WindowManager *glps_wm_init(void);
 
+/**
+ * @brief Initializes the GLPS Window Manager without a display server.
+ *
+ * Rendering goes through EGL_MESA_platform_surfaceless (Mesa, including
+ * llvmpipe without a GPU) or EGL_EXT_platform_device. Windows are offscreen
+ * pbuffers of the requested size, read back with glReadPixels(). The usual
+ * glps_wm_* calls keep working; there is no input, and windows render
+ * uncapped unless glps_wm_window_set_target_fps() says otherwise. Linux only.
+ *
+ * @return The window manager, or NULL if no headless EGL platform is available.
+ */
+glps_WindowManager *glps_wm_init_headless(void);
+
+/**
+ * @brief Returns true if the window manager renders without a display server.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ */
+bool glps_wm_is_headless(glps_WindowManager *wm);
+
 /**
  * @brief Retrieves the platform identifier used by GLPS.
  *
@@ -72,6 +96,13 @@ void glps_wm_window_get_dimensions(glps_WindowManager *wm, size_t window_id,
 /**
  * @brief Sets a callback for window resize events.
  *
+ * On X11 and Wayland, the configure events of an interactive resize are
+ * coalesced: the callback runs at most once per event dispatch pass with
+ * the final size, before the frame update that renders it, and not at all
+ * for moves that keep the size. On X11 the window manager is told through
+ * _NET_WM_SYNC_REQUEST (when XSync is available) once a frame at the new
+ * size has been swapped with glps_wm_swap_buffers().
+ *
  * @param wm Pointer to the GLPS Window Manager.
  * @param window_resize_callback Function called on resize.
  * @param data User data passed to the callback.
@@ -85,6 +116,12 @@ void glps_wm_window_set_resize_callback(
 /**
  * @brief Sets a callback for frame updates.
  *
+ * On Wayland the callback runs when the compositor is ready for a new frame
+ * of the window. The frame callback is re-armed by every
+ * glps_wm_swap_buffers() and glps_wm_window_update(), so rendering from
+ * this callback gives one frame per display refresh while the window is
+ * visible.
+ *
  * @param wm Pointer to the GLPS Window Manager.
  * @param window_frame_update_callback Function called each frame.
  * @param data User data passed to the callback.
@@ -132,9 +169,172 @@ void glps_wm_window_set_close_callback(
     glps_WindowManager *wm,
     void (*window_close_callback)(size_t window_id, void *data), void *data);
 
+/**
+ * @brief Sets a callback that receives presentation feedback for every
+ *        frame committed by glps_wm_swap_buffers() or glps_wm_window_update().
+ *
+ * Reports when the frame was shown, the output refresh interval and the
+ * GLPS_PRESENT_FLAGS, or that it was discarded. Needs wp_presentation on
+ * Wayland. On X11 it reports the vblank glps_wm_window_update() waited for
+ * through the Present extension (refresh_ns is measured, not reported by
+ * the server); it is not called while updates fall back to timer pacing.
+ * Never called on Win32.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_present_callback Function called once per presented frame.
+ * @param data User data passed to the callback.
+ */
+void glps_wm_window_set_present_callback(
+    glps_WindowManager *wm,
+    void (*window_present_callback)(size_t window_id,
+                                    const glps_PresentFeedback *feedback,
+                                    void *data),
+    void *data);
+
+/**
+ * @brief Sets the callback for visibility changes of a window.
+ *
+ * X11 reports windows that are unmapped or minimised as hidden and windows
+ * covered by others as occluded (compositing window managers never report
+ * occlusion). Wayland reports suspended toplevels as hidden and surfaces
+ * the compositor stopped sending frame callbacks for as occluded. Windows
+ * that are not visible stop rendering, or render at the rate set with
+ * glps_wm_window_set_hidden_fps(), and glps_wm_window_update() waits for
+ * events instead. Never called on Win32.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_visibility_callback Function called with the new visibility.
+ * @param data User data passed to the callback.
+ */
+void glps_wm_window_set_visibility_callback(
+    glps_WindowManager *wm,
+    void (*window_visibility_callback)(size_t window_id, GLPS_VISIBILITY visibility,
+                                       void *data),
+    void *data);
+
+/**
+ * @brief Returns the last known visibility of a window, GLPS_VISIBILITY_VISIBLE
+ *        if it is invalid or the platform does not track visibility.
+ */
+GLPS_VISIBILITY glps_wm_window_get_visibility(glps_WindowManager *wm, size_t window_id);
+
+/**
+ * @brief Sets the frame rate of a window while it is occluded or hidden.
+ *
+ * The default of 0 stops frame updates until the window is visible again.
+ * On Wayland, a hidden rate needs a swap interval of 0, since EGL may wait
+ * for frame callbacks the compositor no longer sends. Not supported on Win32.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param fps Rate in Hz, or 0 to stop rendering.
+ */
+void glps_wm_window_set_hidden_fps(glps_WindowManager *wm, size_t window_id, double fps);
+
+/**
+ * @brief Copies the feedback of the last frame of a window that was shown.
+ *
+ * @return true on success, false if no frame has been presented yet, the
+ *         window is invalid or the backend has no presentation feedback.
+ */
+bool glps_wm_window_get_present_feedback(glps_WindowManager *wm, size_t window_id,
+                                         glps_PresentFeedback *feedback);
+
+/**
+ * @brief Sets how often the frame update callback of a window runs.
+ *
+ * GLPS_FPS_DISPLAY (the default) follows the refresh rate of the monitor
+ * the window is on and is re-evaluated when the window moves to another
+ * monitor or the mode changes. A positive value paces the window at that
+ * rate, limited by how often the compositor asks for frames on Wayland.
+ * GLPS_FPS_UNCAPPED never waits: glps_wm_window_update() returns at once
+ * on X11 and the callback runs on every event dispatch pass on Wayland.
+ * Not supported on Win32.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param fps Target rate in Hz, GLPS_FPS_DISPLAY or GLPS_FPS_UNCAPPED.
+ */
+void glps_wm_window_set_target_fps(glps_WindowManager *wm, size_t window_id, double fps);
+
+/**
+ * @brief Chooses when the frame update callback of a window runs.
+ *
+ * In GLPS_RENDER_ON_DEMAND mode the callback only runs after input or a
+ * resize for the window, an expose, a timer set with
+ * glps_wm_request_redraw_after() or a call to glps_wm_request_redraw().
+ * glps_wm_window_update() then sleeps in the event wait instead of
+ * rendering, so an idle window costs no CPU; the wait does not block while
+ * another window has a frame to render. Switching to on-demand renders one
+ * frame. Not supported on Win32.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param mode GLPS_RENDER_CONTINUOUS (the default) or GLPS_RENDER_ON_DEMAND.
+ */
+void glps_wm_window_set_render_mode(glps_WindowManager *wm, size_t window_id,
+                                   GLPS_RENDER_MODE mode);
+
+/**
+ * @brief Makes an on-demand window render its next frame. Call it from the
+ *        thread running the event loop.
+ */
+void glps_wm_request_redraw(glps_WindowManager *wm, size_t window_id);
+
+/**
+ * @brief Makes an on-demand window render once delay_ns have passed, e.g. to
+ *        blink a cursor. An earlier pending timer is kept.
+ */
+void glps_wm_request_redraw_after(glps_WindowManager *wm, size_t window_id, uint64_t delay_ns);
+
+/**
+ * @brief Copies the frame counters of a window.
+ *
+ * @return true on success, false if the window is invalid or the platform
+ *         does not count frames.
+ */
+bool glps_wm_window_get_frame_stats(glps_WindowManager *wm, size_t window_id,
+                                    glps_FrameStats *stats);
+
+/**
+ * @brief Waits until the latest point at which rendering a frame can start
+ *        and still be shown on the next possible vblank.
+ *
+ * Call it from the frame update callback right before sampling input and
+ * rendering, and finish the frame with glps_wm_swap_buffers(). The time
+ * between the two calls is measured and a high percentile of recent frames
+ * decides how far ahead of the vblank rendering has to start, so input is
+ * up to a frame fresher than when sampled at the start of the interval.
+ * Vblanks are predicted from presentation feedback (Present on X11,
+ * wp_presentation on Wayland); without it the call only reports estimates
+ * and returns without sleeping. Not supported on Win32.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window about to be rendered.
+ * @param deadline Receives the predicted present time and render budget.
+ * @return true on success, false if the window is invalid or the platform
+ *         is unsupported.
+ */
+bool glps_wm_frame_begin(glps_WindowManager *wm, size_t window_id, glps_FrameDeadline *deadline);
+
+/**
+ * @brief Returns the refresh rate in Hz of the monitor a window is on.
+ *
+ * Read from RandR on X11 (or measured through Present without it) and from
+ * the wl_output mode on Wayland.
+ *
+ * @return The refresh rate, or 0 if it is not known yet.
+ */
+double glps_wm_window_get_refresh_rate(glps_WindowManager *wm, size_t window_id);
+
 /**
  * @brief Sets the OpenGL context of a window as the current context.
  *
+ * GLPS remembers what each thread last bound and skips the call when the
+ * window is already current, so calling this every frame is cheap. Context
+ * switches made and skipped are counted in glps_FrameStats. Code that calls
+ * eglMakeCurrent() directly must not rely on this call to rebind afterwards.
+ *
  * @param wm Pointer to the GLPS Window Manager.
  * @param window_id ID of the window.
  */
@@ -149,20 +349,135 @@ void glps_wm_set_window_ctx_curr(glps_WindowManager *wm, size_t window_id);
 void glps_wm_swap_buffers(glps_WindowManager *wm, size_t window_id);
 
 /**
- * @brief Sets the swap interval for buffer swaps.
+ * @brief Swaps the buffers of a window, telling the compositor that only
+ *        the given regions changed.
+ *
+ * Uses EGL_KHR_swap_buffers_with_damage or EGL_EXT_swap_buffers_with_damage
+ * (which reach the compositor as wl_surface.damage_buffer on Wayland). Falls
+ * back to a full swap when neither is available, when rects is NULL or
+ * count is 0, and on Win32. Combine with glps_wm_get_buffer_age() to
+ * redraw only the regions that changed since the buffer was last shown.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param rects Changed regions, in window pixels from the top left.
+ * @param count Number of regions.
+ */
+void glps_wm_swap_buffers_with_damage(glps_WindowManager *wm, size_t window_id,
+                                      const glps_Rect *rects, size_t count);
+
+/**
+ * @brief Returns how many frames ago the back buffer of a window was drawn
+ *        (EGL_EXT_buffer_age). Call it with the window's context current,
+ *        before rendering.
+ *
+ * @return The age in frames, or 0 if the contents are undefined, the
+ *         extension is missing or the platform is Win32; redraw everything then.
+ */
+int glps_wm_get_buffer_age(glps_WindowManager *wm, size_t window_id);
+
+/**
+ * @brief Starts recording the frames a window swaps.
+ *
+ * Each glps_wm_swap_buffers() reads the back buffer into a pixel-pack buffer
+ * behind a fence; a later swap picks it up once the GPU is done, usually the
+ * next one, so the render thread never waits. A capture thread then calls the
+ * sink's callback or writes the file. When the GPU or the capture thread
+ * falls behind, frames are dropped and counted rather than stalling. Only
+ * swaps made with the window's surface current are captured. Not supported
+ * on Win32.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param sink Destination of the frames; copied, the path is opened here.
+ * @return true if capture started, false on error or if already capturing.
+ */
+bool glps_wm_capture_start(glps_WindowManager *wm, size_t window_id,
+                           const glps_CaptureSink *sink);
+
+/**
+ * @brief Stops capturing a window. Readbacks still in flight are waited for
+ *        and written, so call it with the GL context current. Destroying the
+ *        window also stops its capture.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param stats Receives the final counters, may be NULL.
+ */
+void glps_wm_capture_stop(glps_WindowManager *wm, size_t window_id, glps_CaptureStats *stats);
+
+/**
+ * @brief Copies the counters of a running capture.
+ *
+ * @return true on success, false if the window is invalid or not capturing.
+ */
+bool glps_wm_capture_get_stats(glps_WindowManager *wm, size_t window_id,
+                               glps_CaptureStats *stats);
+
+/**
+ * @brief Sets the swap interval of every open window.
+ *
+ * Shorthand for glps_wm_window_set_present_mode(): 0 selects
+ * GLPS_PRESENT_MODE_IMMEDIATE, anything else GLPS_PRESENT_MODE_FIFO waiting
+ * that many refreshes per swap. Windows created later start in FIFO mode.
  *
  * @param wm Pointer to the GLPS Window Manager.
  * @param swap_interval Number of vertical refreshes between swaps.
  */
 void glps_wm_swap_interval(glps_WindowManager *wm, unsigned int swap_interval);
+
+/**
+ * @brief Chooses how the swaps of a window line up with the display refresh.
+ *
+ * The mode is kept per window and applied to its surface whenever the surface
+ * is current, so windows sharing the context can use different modes. New
+ * windows use GLPS_PRESENT_MODE_FIFO.
+ *
+ * GLPS_PRESENT_MODE_ADAPTIVE needs a driver accepting negative swap
+ * intervals and behaves as FIFO elsewhere. GLPS_PRESENT_MODE_TEARING uses
+ * wp_tearing_control_v1 on Wayland and behaves as IMMEDIATE where the
+ * compositor lacks it and on X11. For benchmark throughput, also pass
+ * GLPS_FPS_UNCAPPED to glps_wm_window_set_target_fps(). Not supported on Win32.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param mode Present mode.
+ */
+void glps_wm_window_set_present_mode(glps_WindowManager *wm, size_t window_id,
+                                     GLPS_PRESENT_MODE mode);
+
+/**
+ * @brief Returns the present mode requested for a window.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @return The mode, GLPS_PRESENT_MODE_FIFO for invalid windows and on Win32.
+ */
+GLPS_PRESENT_MODE glps_wm_window_get_present_mode(glps_WindowManager *wm, size_t window_id);
 /**
  * @brief Updates a window (polls events, refreshes).
  *
+ * On X11 this waits for the window's next frame at its target rate (see
+ * glps_wm_window_set_target_fps()) through the Present extension, or for a
+ * timer deadline where Present is missing or never signals (e.g. Xvfb),
+ * then calls the frame update callback. An idle on-demand window (see
+ * glps_wm_window_set_render_mode()) waits for events instead.
+ *
  * @param wm Pointer to the GLPS Window Manager.
  * @param window_id ID of the window.
  */
 void glps_wm_window_update(glps_WindowManager *wm, size_t window_id);
 
+/**
+ * @brief Updates every open window once, as glps_wm_window_update() does.
+ *
+ * The window whose context is current on the calling thread goes first, so
+ * a pass over N windows makes N - 1 context switches instead of N.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ */
+void glps_wm_windows_update(glps_WindowManager *wm);
+
 /**
  * @brief Destroys a window.
  *
@@ -185,12 +500,33 @@ void glps_wm_destroy(glps_WindowManager *wm);
  * @return Total window count.
  */
 size_t glps_wm_get_window_count(glps_WindowManager *wm);
+
+/**
+ * @brief Creates a window with flags and its own framebuffer format.
+ *
+ * Configs are matched once per format and cached. With
+ * EGL_KHR_no_config_context, the shared context drives windows of any format;
+ * without it, windows created after the first one fall back to its format.
+ * GLPS_WINDOW_TRANSPARENT adds an alpha channel to the format. Configs are
+ * ignored on Win32.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param title Title of the window.
+ * @param x X position of the window.
+ * @param y Y position of the window.
+ * @param width Width of the window.
+ * @param height Height of the window.
+ * @param flags GLPS_WindowFlags combined with |.
+ * @param config Framebuffer format, NULL for GLPS_SURFACE_CONFIG_DEFAULT.
+ * @return The window ID, or -1 on failure.
+ */
 ssize_t glps_wm_window_create_ex(
     glps_WindowManager *wm,
     const char *title,
     int x, int y,
     int width, int height,
-    GLPS_WindowFlags flags);
+    GLPS_WindowFlags flags,
+    const glps_SurfaceConfig *config);
 
 void glps_wm_move_window(
     glps_WindowManager *wm,
@@ -198,13 +534,186 @@ void glps_wm_move_window(
     int x, int y
 );
 /**
- * @brief Checks if any window should close.
+ * @brief Dispatches the events already received and checks if any window
+ *        should close. Never blocks.
  *
  * @param wm Pointer to the GLPS Window Manager.
  * @return True if the window should close, false otherwise.
  */
 bool glps_wm_should_close(glps_WindowManager *wm);
 
+/**
+ * @brief Sleeps until events arrive, a wakeup is posted, or the timeout
+ *        expires, then dispatches whatever is pending.
+ *
+ * Use in place of glps_wm_should_close() when the application has nothing to
+ * do until the next input event.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param timeout_ns Maximum time to sleep; 0 polls, negative waits forever.
+ * @return True if the window should close, false otherwise.
+ */
+bool glps_wm_wait_events(glps_WindowManager *wm, int64_t timeout_ns);
+
+/**
+ * @brief Wakes a thread blocked in glps_wm_wait_events(). Safe to call from
+ *        any thread.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ */
+void glps_wm_post_wakeup(glps_WindowManager *wm);
+
+/* ======= Event Queue ======= */
+
+/**
+ * @brief Enables the event queue, or disables it when capacity is 0.
+ *
+ * While enabled, every input and window event is also appended to a ring of
+ * capacity entries (rounded up to a power of two), in addition to invoking
+ * the registered callbacks. Events arriving while the ring is full are
+ * dropped and counted in glps_EventStats.queue_overflows. Queued events are
+ * discarded when the queue is resized or disabled. While enabled, every
+ * input class is subscribed to, whether or not a callback observes it.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param capacity Number of events the queue can hold.
+ * @return True on success, false otherwise.
+ */
+bool glps_wm_enable_event_queue(glps_WindowManager *wm, size_t capacity);
+
+/**
+ * @brief Moves up to max_events queued events into events, oldest first.
+ *
+ * Does not read from the display; call after glps_wm_should_close(),
+ * glps_wm_wait_events() or glps_wm_dispatch_pending().
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param events Array receiving the events.
+ * @param max_events Capacity of events.
+ * @return Number of events written.
+ */
+size_t glps_wm_poll_events(glps_WindowManager *wm, glps_Event *events, size_t max_events);
+
+/* ======= Per-Window Event Queues ======= */
+
+/**
+ * @brief Gives each window created from now on its own Wayland event queue.
+ *
+ * The surface, xdg_surface, xdg_toplevel and frame callbacks of such a
+ * window are no longer dispatched by glps_wm_should_close(); the thread
+ * that renders the window dispatches them with glps_wm_window_dispatch(),
+ * and its configure, close and frame update callbacks run on that thread.
+ * Input and registry events stay on the main thread. Windows must be
+ * created and destroyed on the main thread while no window queue is being
+ * dispatched. Only supported on Wayland.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param enable True to create per-window queues, false for the default queue.
+ */
+void glps_wm_enable_window_queues(glps_WindowManager *wm, bool enable);
+
+/**
+ * @brief Dispatches the event queue of one window, waiting up to timeout_ns
+ *        for its events. Safe to call concurrently for different windows,
+ *        and next to the main thread's event pump.
+ *
+ * Events emitted here go into the same glps_wm_poll_events() queue as
+ * those of the main thread, under a lock. Callbacks run on the calling
+ * thread, so they must be thread-safe themselves.
+ *
+ * Windows without their own queue, and other backends, fall back to
+ * glps_wm_wait_events(), which must only be called from the main thread.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param window_id ID of the window.
+ * @param timeout_ns Maximum time to wait; 0 polls, negative waits forever.
+ * @return True if the window manager should close, false otherwise.
+ */
+bool glps_wm_window_dispatch(glps_WindowManager *wm, size_t window_id, int64_t timeout_ns);
+
+/* ======= Input Thread ======= */
+
+/**
+ * @brief Starts reading backend events on a dedicated thread.
+ *
+ * Events are read as soon as they arrive, even while the render thread is
+ * busy with a frame, and handed over through a lock-free ring of capacity
+ * entries. They are delivered on the render thread by the usual calls
+ * (glps_wm_should_close(), glps_wm_wait_events(), glps_wm_dispatch_pending())
+ * in the order they were read. When the ring is full new events are
+ * dropped and counted in glps_EventStats.input_overflows; the input thread
+ * never blocks on the render thread. Best started right after
+ * glps_wm_init(), before any window exists. Linux only.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param capacity Number of events the ring can hold.
+ * @return True on success, false otherwise.
+ */
+bool glps_wm_start_input_thread(glps_WindowManager *wm, size_t capacity);
+
+/**
+ * @brief Stops the input thread. Events it already read are still delivered.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ */
+void glps_wm_stop_input_thread(glps_WindowManager *wm);
+
+/* ======= External Event Loop ======= */
+
+/**
+ * @brief Returns the file descriptors an external event loop should watch for
+ *        readability: the display connection and the wakeup eventfd.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @param fds Array receiving the descriptors.
+ * @param max_fds Capacity of fds; 2 is always enough.
+ * @return Number of descriptors written.
+ */
+size_t glps_wm_get_fds(glps_WindowManager *wm, int *fds, size_t max_fds);
+
+/**
+ * @brief Flushes outgoing requests and prepares to read from the display.
+ *        Call before the host loop goes to sleep.
+ *
+ * Every call must be followed by glps_wm_dispatch_pending(), whether or not
+ * a descriptor became ready.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @return True if it is safe to sleep on the descriptors, false if events
+ *         are already queued and glps_wm_dispatch_pending() should run now.
+ */
+bool glps_wm_prepare(glps_WindowManager *wm);
+
+/**
+ * @brief Returns how long a host loop may sleep before GLPS has work of its
+ *        own: a deferred or redraw-timer frame, a hidden window's frame at
+ *        its hidden rate, or a window that renders uncapped.
+ *
+ * Call after glps_wm_prepare() and clamp the host loop's timeout to it;
+ * glps_wm_dispatch_pending() then runs the frames that are due. On X11 and
+ * headless windows frames are driven by glps_wm_window_update() and
+ * nothing is scheduled here.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @return Nanoseconds until the next scheduled frame, 0 if one is due now,
+ *         or -1 if nothing is scheduled.
+ */
+int64_t glps_wm_next_timeout_ns(glps_WindowManager *wm);
+
+/**
+ * @brief Reads whatever is available without blocking and dispatches it.
+ *
+ * @param wm Pointer to the GLPS Window Manager.
+ * @return True if the window should close, false otherwise.
+ */
+bool glps_wm_dispatch_pending(glps_WindowManager *wm);
+
+/*
+ * Input is only subscribed to once a callback observes it: until a keyboard,
+ * mouse or touch callback is set, the matching device is not bound on
+ * Wayland and its events are not selected on X11.
+ */
+
 /* ======= Keyboard Events ======= */
 
 /**
@@ -328,6 +837,35 @@ void glps_wm_start_drag_n_drop(
  */
 double glps_wm_get_fps(glps_WindowManager *wm, size_t window_id);
 
+/**
+ * @brief Copies the event drain counters (processed, merged, dropped) into stats.
+ */
+void glps_wm_get_event_stats(glps_WindowManager *wm, glps_EventStats *stats);
+
+/**
+ * @brief Returns the CLOCK_MONOTONIC time, in nanoseconds, of the event whose
+ *        callback is running on the calling thread. Events read from
+ *        glps_wm_poll_events() carry the same value in glps_Event::timestamp_ns.
+ */
+uint64_t glps_wm_get_event_timestamp(glps_WindowManager *wm);
+
+/**
+ * @brief Copies the input-to-swap latency histogram of a window.
+ *
+ * A sample starts at the first input event delivered to the window and ends
+ * when the next glps_wm_swap_buffers() on that window returns. Bucket i counts
+ * samples below 2^i microseconds. Not available on Win32.
+ *
+ * @return true on success, false if the window is invalid or unsupported.
+ */
+bool glps_wm_get_latency_histogram(glps_WindowManager *wm, size_t window_id,
+                                   glps_LatencyHistogram *histogram);
+
+/**
+ * @brief Clears the latency histogram and any pending sample of a window.
+ */
+void glps_wm_reset_latency_histogram(glps_WindowManager *wm, size_t window_id);
+
 /**
  * @brief Returns the address of an OpenGL/Vulkan procedure.
  */
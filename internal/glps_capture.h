@@ -0,0 +1,41 @@
+#ifndef GLPS_CAPTURE_H
+#define GLPS_CAPTURE_H
+
+#include "glps_common.h"
+
+/**
+ * @file glps_capture.h
+ * @brief Asynchronous readback of swapped frames.
+ *
+ * On every swap of a capturing window the back buffer is read into the next
+ * of a small ring of pixel-pack buffers and a fence is inserted behind the
+ * read. Later swaps poll the fences without waiting; a finished buffer is
+ * mapped, copied into a free frame of the capture thread's pool and queued.
+ * The capture thread converts and writes the frame, so the render thread
+ * never waits for the GPU or the disk. A swap finding every readback buffer
+ * still in flight, or no free frame, drops its frame and counts it.
+ *
+ * All functions run on the render thread with the GL context current.
+ */
+
+#define GLPS_CAPTURE_RING_SIZE 3  /**< Readbacks in flight. */
+#define GLPS_CAPTURE_QUEUE_SIZE 4 /**< Frames queued for the capture thread, power of two. */
+
+bool glps_capture_start(glps_WindowManager *wm, size_t window_id, const glps_CaptureSink *sink);
+
+/**
+ * @brief Waits for the readbacks in flight, flushes them to the sink and
+ *        releases the capture. Called by the backends when a window goes away.
+ * @param stats Receives the final counters, may be NULL.
+ */
+void glps_capture_stop(glps_WindowManager *wm, size_t window_id, glps_CaptureStats *stats);
+
+/**
+ * @brief Collects finished readbacks and reads the back buffer of the window.
+ *        Call right before its surface is swapped.
+ */
+void glps_capture_frame(glps_WindowManager *wm, size_t window_id);
+
+bool glps_capture_get_stats(glps_WindowManager *wm, size_t window_id, glps_CaptureStats *stats);
+
+#endif
@@ -43,6 +43,10 @@
 #include <sys/mman.h>
 // Wayland protocol extensions
 #include "xdg-shell.h"
+#include "presentation-time.h"
+#ifdef GLPS_HAVE_TEARING_CONTROL
+#include "tearing-control-v1.h"
+#endif
 //#include "xdg/xdg-decorations.h"
 //#include "xdg/xdg-toplevel-tag.h"
 //#include "xdg/wlr-data-control-unstable-v1.h"
@@ -59,6 +63,10 @@
 
 #endif
 
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+#include "glps_thread.h"
+#endif
+
 #ifdef GLPS_USE_VULKAN
 #include <vulkan/vulkan.h>
 #ifdef GLPS_USE_X11
@@ -72,6 +80,9 @@
 // Forward declarations and common types that don't depend on platform
 typedef struct glps_WindowManager glps_WindowManager;
 typedef struct glps_Callback glps_Callback;
+struct glps_WindowIndexEntry;
+struct glps_InputThread;
+struct glps_Capture;
 
 /**
  * @enum GLPS_SCROLL_AXES
@@ -114,6 +125,26 @@ typedef enum {
     GLPS_WINDOW_TRANSPARENT = 1 << 1
 } GLPS_WindowFlags;
 
+/**
+ * @struct glps_SurfaceConfig
+ * @brief Framebuffer format of a window, see glps_wm_window_create_ex().
+ *
+ * Sizes are minimums; among the matching EGL configs the one with the fewest
+ * extra bits is used.
+ */
+typedef struct {
+    int red_bits, green_bits, blue_bits;
+    int alpha_bits;   /**< 0 for an opaque window. */
+    int depth_bits;
+    int stencil_bits;
+    int samples;      /**< MSAA samples per pixel, 0 or 1 for none. */
+    bool srgb;        /**< sRGB-encoded color buffer (EGL_KHR_gl_colorspace). */
+} glps_SurfaceConfig;
+
+/** RGBA8 without depth, stencil or MSAA: the format of glps_wm_window_create(). */
+#define GLPS_SURFACE_CONFIG_DEFAULT \
+    ((glps_SurfaceConfig){.red_bits = 8, .green_bits = 8, .blue_bits = 8, .alpha_bits = 8})
+
 /**
  * @struct glps_WindowProperties
  * @brief Properties for a GLPS window.
@@ -124,6 +155,296 @@ typedef struct {
     int height;
 } glps_WindowProperties;
 
+/**
+ * @struct glps_Rect
+ * @brief A rectangle in window pixels, with the origin at the top left.
+ */
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} glps_Rect;
+
+/**
+ * @enum GLPS_EVENT_TYPE
+ * @brief Event types delivered through glps_wm_poll_events().
+ */
+typedef enum {
+    GLPS_EVENT_NONE,
+    GLPS_EVENT_KEYBOARD_ENTER,
+    GLPS_EVENT_KEYBOARD_LEAVE,
+    GLPS_EVENT_KEY,
+    GLPS_EVENT_MOUSE_ENTER,
+    GLPS_EVENT_MOUSE_LEAVE,
+    GLPS_EVENT_MOUSE_MOVE,
+    GLPS_EVENT_MOUSE_CLICK,
+    GLPS_EVENT_MOUSE_SCROLL,
+    GLPS_EVENT_TOUCH,
+    GLPS_EVENT_WINDOW_RESIZE,
+    GLPS_EVENT_WINDOW_CLOSE,
+    GLPS_EVENT_WINDOW_VISIBILITY,
+} GLPS_EVENT_TYPE;
+
+/**
+ * @enum GLPS_VISIBILITY
+ * @brief Whether a window's content can currently be seen.
+ */
+typedef enum {
+    GLPS_VISIBILITY_VISIBLE,  /**< At least partially on screen. */
+    GLPS_VISIBILITY_OCCLUDED, /**< Mapped, but fully covered by other windows. */
+    GLPS_VISIBILITY_HIDDEN,   /**< Unmapped, minimised or suspended by the compositor. */
+} GLPS_VISIBILITY;
+
+#define GLPS_EVENT_KEY_TEXT_SIZE 32
+
+/**
+ * @struct glps_Event
+ * @brief A single input or window event. The active member follows type.
+ */
+typedef struct {
+    GLPS_EVENT_TYPE type;
+    size_t window_id;
+    uint64_t timestamp_ns; /**< CLOCK_MONOTONIC time the event happened. */
+    union {
+        struct {
+            bool state;                           /**< True on press. */
+            unsigned long keycode;
+            char text[GLPS_EVENT_KEY_TEXT_SIZE]; /**< UTF-8 text or key name, truncated. */
+        } key;                                    /**< GLPS_EVENT_KEY */
+        struct {
+            double x;
+            double y;
+        } mouse;                                  /**< GLPS_EVENT_MOUSE_ENTER, GLPS_EVENT_MOUSE_MOVE */
+        struct {
+            bool state;                           /**< True on press. */
+        } click;                                  /**< GLPS_EVENT_MOUSE_CLICK */
+        struct {
+            GLPS_SCROLL_AXES axis;
+            GLPS_SCROLL_SOURCE source;
+            double value;
+            int discrete;
+            bool is_stopped;
+        } scroll;                                 /**< GLPS_EVENT_MOUSE_SCROLL */
+        struct {
+            int id;
+            double x;
+            double y;
+            bool state;                           /**< True while the point is down. */
+            double major;
+            double minor;
+            double orientation;
+        } touch;                                  /**< GLPS_EVENT_TOUCH */
+        struct {
+            int width;
+            int height;
+        } resize;                                 /**< GLPS_EVENT_WINDOW_RESIZE */
+        struct {
+            GLPS_VISIBILITY state;
+        } visibility;                             /**< GLPS_EVENT_WINDOW_VISIBILITY */
+    };
+} glps_Event;
+
+#define GLPS_LATENCY_BUCKET_COUNT 24
+
+/**
+ * @struct glps_LatencyHistogram
+ * @brief Input-to-swap latency of a window.
+ *
+ * Each sample is the time from the oldest input event delivered to the
+ * window since its previous swap until glps_wm_swap_buffers() returned.
+ * buckets[i] counts samples from 2^i up to 2^(i+1) microseconds; bucket 0
+ * also takes anything shorter and the last bucket anything longer.
+ */
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t buckets[GLPS_LATENCY_BUCKET_COUNT];
+} glps_LatencyHistogram;
+
+/**
+ * @struct glps_LatencyProbe
+ * @brief Per-window latency bookkeeping (see glps_latency.h).
+ */
+typedef struct {
+    uint64_t pending_since_ns; /**< Oldest input not yet followed by a swap, 0 if none. */
+    glps_LatencyHistogram histogram;
+} glps_LatencyProbe;
+
+#define GLPS_RENDER_SAMPLE_COUNT 32
+
+/**
+ * @enum GLPS_RENDER_MODE
+ * @brief When the frame update callback of a window runs.
+ */
+typedef enum {
+    GLPS_RENDER_CONTINUOUS, /**< Every frame, paced at the window's target rate. */
+    GLPS_RENDER_ON_DEMAND,  /**< Only after input, resize, expose, a timer or a redraw request. */
+} GLPS_RENDER_MODE;
+
+/**
+ * @struct glps_FrameStats
+ * @brief Per-window frame counters, see glps_wm_window_get_frame_stats().
+ */
+typedef struct {
+    uint64_t frames;                   /**< Frame update callbacks invoked. */
+    uint64_t redraw_requests;          /**< Redraws requested by events, timers or the application. */
+    uint64_t idle_waits;               /**< glps_wm_window_update() calls that waited without rendering. */
+    uint64_t context_switches;         /**< eglMakeCurrent() calls that bound the window. */
+    uint64_t context_switches_skipped; /**< Requests for a binding that was already current. */
+} glps_FrameStats;
+#define GLPS_FPS_DISPLAY 0.0     /**< Follow the refresh rate of the window's monitor. */
+#define GLPS_FPS_UNCAPPED (-1.0) /**< Never wait between frames. */
+
+/**
+ * @struct glps_FrameSchedule
+ * @brief Per-window frame pacing (see glps_scheduler.h).
+ */
+typedef struct {
+    double target_fps;      /**< GLPS_FPS_DISPLAY, GLPS_FPS_UNCAPPED or a rate in Hz. */
+    uint64_t refresh_ns;    /**< Refresh interval of the window's monitor, 0 if unknown. */
+    uint64_t next_frame_ns; /**< CLOCK_MONOTONIC deadline of the next frame, 0 to restart. */
+    bool deferred;          /**< The compositor asked for a frame before the deadline. */
+    uint64_t render_begin_ns;                      /**< Set by glps_wm_frame_begin(), cleared on swap. */
+    uint64_t render_ns[GLPS_RENDER_SAMPLE_COUNT]; /**< Ring of recent render durations. */
+    size_t render_count;                           /**< Durations recorded so far. */
+    GLPS_RENDER_MODE render_mode;
+    bool redraw_pending;   /**< An on-demand window has to render its next frame. */
+    uint64_t redraw_at_ns; /**< Timed redraw of an on-demand window, 0 if none. */
+    GLPS_VISIBILITY visibility;
+    double hidden_fps;      /**< Rate while not visible, 0 to stop rendering. */
+    uint64_t last_frame_ns; /**< Start of the last frame update. */
+    glps_FrameStats stats;
+} glps_FrameSchedule;
+
+/**
+ * @struct glps_ResizeState
+ * @brief Size changes held back until the next frame, so a flood of
+ *        configure events reaches the application once per frame.
+ */
+typedef struct {
+    int width, height; /**< Size last delivered to the application. */
+    int pending_width, pending_height;
+    bool pending;
+} glps_ResizeState;
+
+/**
+ * @enum GLPS_PRESENT_MODE
+ * @brief How a window's swaps line up with the display refresh.
+ */
+typedef enum {
+    GLPS_PRESENT_MODE_FIFO,      /**< Wait for vblank, never tear (swap interval 1). */
+    GLPS_PRESENT_MODE_ADAPTIVE,  /**< Wait for vblank, tear only when a frame is late. */
+    GLPS_PRESENT_MODE_IMMEDIATE, /**< Do not wait for vblank (swap interval 0). */
+    GLPS_PRESENT_MODE_TEARING,   /**< Immediate, and ask the compositor for tearing flips. */
+} GLPS_PRESENT_MODE;
+
+/**
+ * @struct glps_PresentState
+ * @brief Present mode of a window. EGL keeps the swap interval per surface,
+ *        so it is applied whenever the window's surface is made current.
+ */
+typedef struct {
+    GLPS_PRESENT_MODE mode;
+    int swap_interval; /**< Refreshes per swap in FIFO and adaptive modes. */
+    bool applied;      /**< The surface already uses the interval of mode. */
+} glps_PresentState;
+
+/**
+ * @enum GLPS_CAPTURE_SINK
+ * @brief Where frames read back by glps_wm_capture_start() go.
+ */
+typedef enum {
+    GLPS_CAPTURE_SINK_CALLBACK, /**< Hand each frame to glps_CaptureSink::callback. */
+    GLPS_CAPTURE_SINK_Y4M,      /**< Write a YUV4MPEG2 4:2:0 stream to glps_CaptureSink::path. */
+    GLPS_CAPTURE_SINK_RAW,      /**< Append packed RGBA8 frames to glps_CaptureSink::path. */
+} GLPS_CAPTURE_SINK;
+
+/**
+ * @struct glps_CaptureFrame
+ * @brief A captured frame as seen by a callback sink.
+ */
+typedef struct {
+    size_t window_id;
+    int width, height;
+    size_t stride;          /**< Bytes per row; rows run top to bottom. */
+    const uint8_t *pixels;  /**< RGBA8, only valid during the callback. */
+    uint64_t index;         /**< Swap count since capture started; gaps are drops. */
+    uint64_t timestamp_ns;  /**< When the frame was swapped, CLOCK_MONOTONIC. */
+} glps_CaptureFrame;
+
+/**
+ * @struct glps_CaptureSink
+ * @brief Destination of a capture. Callbacks run on the capture thread.
+ */
+typedef struct {
+    GLPS_CAPTURE_SINK type;
+    const char *path; /**< Output file of the Y4M and raw sinks. */
+    double fps;       /**< Rate written to the Y4M header, 0 for 60. */
+    void (*callback)(const glps_CaptureFrame *frame, void *data);
+    void *data;
+} glps_CaptureSink;
+
+/**
+ * @struct glps_CaptureStats
+ * @brief Counters of a capture, see glps_wm_capture_get_stats().
+ */
+typedef struct {
+    uint64_t frames_read;    /**< Swaps whose back buffer was read back. */
+    uint64_t frames_written; /**< Frames the sink accepted. */
+    uint64_t late_frames;    /**< Readbacks not finished by the following swap. */
+    uint64_t dropped_gpu;    /**< Swaps skipped because every readback buffer was in flight. */
+    uint64_t dropped_sink;   /**< Frames dropped because the capture thread fell behind. */
+    uint64_t dropped_size;   /**< Frames the sink rejected, e.g. a Y4M stream changing size. */
+} glps_CaptureStats;
+
+/**
+ * @struct glps_FrameDeadline
+ * @brief Timing of the next frame returned by glps_wm_frame_begin(). All
+ *        times are CLOCK_MONOTONIC nanoseconds.
+ */
+typedef struct {
+    uint64_t present_ns;      /**< Predicted time the frame reaches the display. */
+    uint64_t render_start_ns; /**< Latest time to start rendering and still make it. */
+    uint64_t render_ns;       /**< Estimated render duration, including a safety margin. */
+    uint64_t refresh_ns;      /**< Refresh interval of the window's monitor. */
+    bool predicted;           /**< present_ns follows measured vblanks, not an estimate. */
+} glps_FrameDeadline;
+
+/**
+ * @brief glps_PresentFeedback::flags, same values as wp_presentation_feedback.kind.
+ */
+typedef enum {
+    GLPS_PRESENT_FLAG_VSYNC         = 0x1, /**< Presented in sync with the display refresh. */
+    GLPS_PRESENT_FLAG_HW_CLOCK      = 0x2, /**< Timestamp comes from the display hardware. */
+    GLPS_PRESENT_FLAG_HW_COMPLETION = 0x4, /**< Completion was signalled by the hardware. */
+    GLPS_PRESENT_FLAG_ZERO_COPY     = 0x8, /**< The buffer was scanned out directly. */
+} GLPS_PRESENT_FLAGS;
+
+/**
+ * @struct glps_PresentFeedback
+ * @brief When and how a frame reached the screen.
+ */
+typedef struct {
+    uint64_t present_ns; /**< Time the frame turned into light, CLOCK_MONOTONIC. */
+    uint64_t refresh_ns; /**< Refresh interval of the output, 0 if unknown. */
+    uint64_t msc;        /**< Vertical retrace counter of the output. */
+    uint32_t flags;      /**< GLPS_PRESENT_FLAGS. */
+    bool discarded;      /**< Frame was never shown; the other fields are 0. */
+} glps_PresentFeedback;
+
+/**
+ * @struct glps_InputClock
+ * @brief Maps 32-bit millisecond server timestamps onto CLOCK_MONOTONIC.
+ */
+typedef struct {
+    bool valid;
+    uint32_t last_ms;
+    uint64_t wraps;    /**< Times the millisecond counter wrapped around. */
+    int64_t offset_ns; /**< Smallest (monotonic - server) difference seen. */
+} glps_InputClock;
+
 /**
  * @struct glps_Callback
  * @brief Callback function pointers for window events.
@@ -156,6 +477,9 @@ struct glps_Callback {
     void (*window_resize_callback)(size_t window_id, int width, int height, void *data);
     void (*window_close_callback)(size_t window_id, void *data);
     void (*window_frame_update_callback)(size_t window_id, void *data);
+    void (*window_present_callback)(size_t window_id, const glps_PresentFeedback *feedback,
+                                   void *data);
+    void (*window_visibility_callback)(size_t window_id, GLPS_VISIBILITY visibility, void *data);
 
     // User data for each callback
     void *mouse_enter_data;
@@ -171,6 +495,8 @@ struct glps_Callback {
     void *window_resize_data;
     void *window_frame_update_data;
     void *window_close_data;
+    void *window_present_data;
+    void *window_visibility_data;
 };
 
 // Platform-specific structures
@@ -238,6 +564,15 @@ typedef struct {
     int y;
 } glps_DropCoordinates;
 
+#define GLPS_PRESENT_FEEDBACK_MAX 4 /**< Frames in flight with a feedback request. */
+#define GLPS_MAX_OUTPUTS 8
+
+typedef struct {
+    struct wl_output *wl_output;
+    uint32_t name;       /**< Registry name, for global_remove. */
+    uint64_t refresh_ns; /**< Interval of the current mode, 0 until known. */
+} glps_WaylandOutput;
+
 typedef struct glps_WaylandWindow {
     struct xdg_surface *xdg_surface;
     struct xdg_toplevel *xdg_toplevel;
@@ -246,18 +581,39 @@ typedef struct glps_WaylandWindow {
     struct wl_egl_window *egl_window;
     glps_WindowProperties properties;
     struct wl_callback *frame_callback;
+    uint64_t frame_requested_ns;  /**< When frame_callback was requested. */
+    glps_ResizeState resize;
+    bool suspended;               /**< The toplevel is in the suspended state. */
     struct timespec fps_start_time;
     bool fps_is_init;
     void *frame_args;
     uint32_t serial;
     bool configured;
+    glps_LatencyProbe latency;
+    struct wl_event_queue *queue; /**< Own queue, or NULL for the default one. */
+    struct wp_presentation_feedback *present_feedback[GLPS_PRESENT_FEEDBACK_MAX];
+    glps_PresentFeedback last_present;
+    glps_FrameSchedule schedule;
+    struct wl_output *output;     /**< Output the surface last entered. Guarded by shared_lock. */
+    uint64_t pending_refresh_ns;  /**< New refresh of output for a window queue thread to apply, 0 if none. Guarded by shared_lock. */
+    glps_PresentState present;
+    struct glps_Capture *capture; /**< Frame readback, NULL unless capturing. */
+#ifdef GLPS_HAVE_TEARING_CONTROL
+    struct wp_tearing_control_v1 *tearing_control; /**< Created on first use. */
+#endif
 } glps_WaylandWindow;
 typedef struct {
     struct wl_display *wl_display;
     struct wl_registry *wl_registry;
     struct wl_compositor *wl_compositor;
     struct wl_seat *wl_seat;
+    uint32_t seat_capabilities; /**< Last wl_seat.capabilities received. */
     struct xdg_wm_base *xdg_wm_base;
+    struct wp_presentation *wp_presentation; /**< NULL if the compositor lacks it. */
+    uint32_t presentation_clock;             /**< clockid_t of feedback timestamps. */
+#ifdef GLPS_HAVE_TEARING_CONTROL
+    struct wp_tearing_control_manager_v1 *tearing_control_manager; /**< NULL if unsupported. */
+#endif
         struct wl_shm *wl_shm;
 
    // struct zxdg_decoration_manager_v1 *decoration_manager;
@@ -279,18 +635,37 @@ typedef struct {
     size_t touch_window_id;
     size_t current_drag_n_drop_window;
     glps_DropCoordinates drop_coordinates;
+    bool read_prepared; /**< wl_display_prepare_read() done, read pending. */
+    bool window_queues; /**< New windows get their own wl_event_queue. */
+    glps_WaylandOutput outputs[GLPS_MAX_OUTPUTS];
+    size_t output_count;
 } glps_WaylandContext;
 
 #endif // GLPS_USE_WAYLAND
 
 #if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+#define GLPS_EGL_CONFIG_CACHE_SIZE 8
+
+typedef struct {
+    glps_SurfaceConfig format;
+    EGLConfig config;
+} glps_EGLConfigEntry;
+
 typedef struct {
     EGLDisplay dpy;
     EGLContext ctx;
-    EGLConfig conf;
+    EGLint surface_type; /**< EGL_WINDOW_BIT, or EGL_PBUFFER_BIT when headless. */
+    EGLConfig conf;  /**< Config of the context, and of every surface without no_config_context. */
     #ifdef GLPS_USE_X11
     VisualID  x11_visual_id;
     #endif
+    /** EGL_KHR/EXT_swap_buffers_with_damage, NULL if unsupported. */
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC swap_buffers_with_damage;
+    bool has_buffer_age; /**< EGL_EXT_buffer_age */
+    bool has_no_config_context; /**< EGL_KHR_no_config_context: ctx works with any config. */
+    bool has_gl_colorspace;     /**< EGL_KHR_gl_colorspace */
+    glps_EGLConfigEntry configs[GLPS_EGL_CONFIG_CACHE_SIZE]; /**< Configs chosen per format. */
+    size_t config_count;
 } glps_EGLContext;
 #endif
 
@@ -312,12 +687,29 @@ typedef struct {
 #endif
 
 #ifdef GLPS_USE_X11
+typedef struct {
+    int x, y;
+    int width, height;
+    uint64_t refresh_ns; /**< Interval of the CRTC's mode, 0 if unknown. */
+} glps_X11Monitor;
+
 typedef struct {
     Display *display;
     GC gc;
     Atom wm_delete_window;
     XFontStruct *font;
     Cursor cursor;
+    XEvent *event_batch;         /**< Events read by the current drain. */
+    size_t event_batch_capacity;
+    uint64_t drain_pass;         /**< Incremented once per drain. */
+    long input_mask;             /**< XSelectInput mask of every window. */
+    int present_opcode;          /**< Present extension opcode, 0 if unavailable. */
+    int randr_event_base;        /**< RandR event base, 0 if unavailable. */
+    glps_X11Monitor *monitors;   /**< Active CRTCs, reloaded on screen changes. */
+    size_t monitor_count;
+    Atom net_wm_sync_request;
+    Atom net_wm_sync_request_counter;
+    bool have_sync;              /**< XSync is available for _NET_WM_SYNC_REQUEST. */
 } glps_X11Context;
 
 typedef struct {
@@ -327,6 +719,23 @@ typedef struct {
     bool fps_is_init;
     struct timespec fps_start_time;
     bool is_desktop;
+    uint64_t configure_pass;     /**< Drain that last saw a ConfigureNotify. */
+    size_t configure_index;      /**< Batch index of that ConfigureNotify. */
+    glps_LatencyProbe latency;
+    XID present_eid;             /**< Present event context, 0 when pacing with a timer. */
+    bool present_pending;        /**< PresentNotifyMSC sent, completion not seen yet. */
+    uint64_t present_msc;        /**< MSC of the last vblank notification. */
+    uint64_t present_ust_ns;     /**< Time of that vblank, CLOCK_MONOTONIC. */
+    glps_PresentFeedback last_present;
+    glps_FrameSchedule schedule;
+    ssize_t monitor;             /**< Index into glps_X11Context::monitors, -1 if unknown. */
+    glps_ResizeState resize;
+    XID sync_counter;            /**< _NET_WM_SYNC_REQUEST_COUNTER, 0 without XSync. */
+    uint64_t sync_value;         /**< Value the window manager asked the counter to reach. */
+    bool sync_pending;           /**< Set the counter after the next frame at the new size. */
+    glps_PresentState present;
+    struct glps_Capture *capture; /**< Frame readback, NULL unless capturing. */
+    Colormap colormap;           /**< Own colormap for a non-default visual, else None. */
 } glps_X11Window;
 #endif
 
@@ -347,6 +756,40 @@ struct glps_debug {
     bool enable_fps_counter;
 };
 
+/**
+ * @struct glps_EventStats
+ * @brief Counters for the backend event drain.
+ */
+typedef struct {
+    uint64_t events_processed; /**< Events delivered to a window. */
+    uint64_t events_merged;    /**< Events superseded by a newer one of the same kind. */
+    uint64_t events_dropped;   /**< Events discarded without being delivered. */
+    uint64_t queue_overflows;  /**< Events lost because the event queue was full. */
+    uint64_t input_overflows;  /**< Events lost because the input thread ring was full. */
+} glps_EventStats;
+
+/**
+ * @struct glps_EventQueue
+ * @brief Fixed-capacity ring filled by the backends (see glps_events.h).
+ */
+typedef struct {
+    glps_Event *events;
+    size_t capacity; /**< Power of two, 0 while the queue is disabled. */
+    size_t head;     /**< Next slot to read. */
+    size_t tail;     /**< Next slot to write. */
+} glps_EventQueue;
+
+/**
+ * @struct glps_WindowTable
+ * @brief Slot bookkeeping for wm->windows (see glps_window_table.h).
+ */
+typedef struct {
+    uint32_t *generations; /**< Current generation of each slot. */
+    size_t *free_slots;    /**< Stack of free slot indices. */
+    size_t free_count;
+    size_t capacity;       /**< Number of slots in wm->windows. */
+} glps_WindowTable;
+
 /**
  * @struct glps_WindowManager
  * @brief Main window manager structure.
@@ -375,11 +818,22 @@ struct glps_WindowManager {
 #endif
 
     // Common fields
+    struct glps_WindowIndexEntry *window_index; /**< Native handle -> window ID. */
+    glps_WindowTable window_table;
     char font_path[256];
-    size_t window_count;
+    size_t window_count; /**< Number of live windows. */
     bool inhibit_reset;
     unsigned int selected_color;
     struct glps_debug debug_utilities;
+    glps_EventStats event_stats;
+    glps_EventQueue event_queue;
+    struct glps_InputThread *input_thread; /**< NULL unless started. */
+    glps_InputClock input_clock;
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+    gthread_mutex_t shared_lock; /**< Guards the event queue and outputs against window queue threads. */
+    int wakeup_fd; /**< eventfd written by glps_wm_post_wakeup(). */
+    bool headless; /**< No display server; windows are EGL pbuffers. */
+#endif
     struct glps_Callback callbacks;
     bool should_close;
 };
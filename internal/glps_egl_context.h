@@ -4,11 +4,39 @@
 #include <glps_common.h>
 
 
-void glps_egl_init(glps_WindowManager *wm, EGLNativeDisplayType display);
+bool glps_egl_init(glps_WindowManager *wm, EGLNativeDisplayType display);
+bool glps_egl_init_display(glps_WindowManager *wm, EGLDisplay dpy, EGLint surface_type);
+bool glps_egl_has_extension(const char *extensions, const char *name);
 void glps_egl_create_ctx(glps_WindowManager *wm);
+EGLConfig glps_egl_choose_config(glps_WindowManager *wm, const glps_SurfaceConfig *format);
+EGLSurface glps_egl_create_surface(glps_WindowManager *wm, EGLConfig config,
+                                   const glps_SurfaceConfig *format, EGLNativeWindowType native);
+EGLSurface glps_egl_create_pbuffer(glps_WindowManager *wm, EGLConfig config,
+                                   const glps_SurfaceConfig *format, int width, int height);
+
+/**
+ * @brief Binds the window's surface on the calling thread, unless GLPS
+ *        already bound it there. Counted in the window's glps_FrameStats.
+ */
 void glps_egl_make_ctx_current(glps_WindowManager *wm, size_t window_id);
+
+/**
+ * @brief Unbinds surface if it is current on the calling thread. Call before
+ *        destroying a surface so the current-binding cache never outlives it.
+ */
+void glps_egl_release_surface(glps_WindowManager *wm, EGLSurface surface);
+
+/**
+ * @brief Window whose surface the calling thread has current, or -1.
+ */
+ssize_t glps_egl_current_window(glps_WindowManager *wm);
+
+void glps_egl_apply_present_mode(glps_WindowManager *wm, size_t window_id);
 void *glps_egl_get_proc_addr(const char *name);
 void glps_egl_swap_buffers(glps_WindowManager *wm, size_t window_id);
+void glps_egl_swap_buffers_with_damage(glps_WindowManager *wm, size_t window_id,
+                                       const glps_Rect *rects, size_t count);
+int glps_egl_get_buffer_age(glps_WindowManager *wm, size_t window_id);
 void glps_egl_destroy(glps_WindowManager *wm);
 
 #endif
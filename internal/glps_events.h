@@ -0,0 +1,106 @@
+#ifndef GLPS_EVENTS_H
+#define GLPS_EVENTS_H
+
+#include "glps_common.h"
+
+/**
+ * @file glps_events.h
+ * @brief Single delivery path for backend events.
+ *
+ * Backends describe every input and window event as a glps_Event and hand
+ * it to glps_events_emit(), which appends it to the event queue (when
+ * enabled) and invokes the matching callback. Input and resize events also
+ * request a redraw of on-demand windows. Frame update callbacks are render
+ * triggers rather than input and go through glps_events_dispatch_frame(). Events
+ * emitted on the input thread are pushed to its ring and emitted again on
+ * the render thread when the ring is drained. Events emitted with a zero
+ * timestamp_ns are stamped with the current time.
+ */
+
+/**
+ * @brief Input classes the application can observe, see glps_events_interest().
+ */
+typedef enum {
+    GLPS_EVENT_INTEREST_POINTER_MOTION = 1 << 0, /**< Move, enter, leave. */
+    GLPS_EVENT_INTEREST_POINTER_BUTTON = 1 << 1, /**< Click, scroll. */
+    GLPS_EVENT_INTEREST_KEYBOARD       = 1 << 2,
+    GLPS_EVENT_INTEREST_TOUCH          = 1 << 3,
+    GLPS_EVENT_INTEREST_ALL            = 0xF,
+} GLPS_EVENT_INTEREST;
+
+bool glps_events_queue_init(glps_WindowManager *wm, size_t capacity);
+void glps_events_queue_destroy(glps_WindowManager *wm);
+
+/**
+ * @brief Moves up to max queued events into out, oldest first.
+ * @return Number of events written.
+ */
+size_t glps_events_queue_pop(glps_WindowManager *wm, glps_Event *out, size_t max);
+
+/**
+ * @brief Returns the GLPS_EVENT_INTEREST bits backed by a registered callback,
+ *        or all of them while the event queue is enabled. Backends only
+ *        subscribe to those input classes.
+ */
+unsigned int glps_events_interest(glps_WindowManager *wm);
+
+/**
+ * @brief Timestamp of the event whose callback is running on the calling
+ *        thread, see glps_wm_get_event_timestamp().
+ */
+uint64_t glps_events_current_timestamp(void);
+
+/**
+ * @brief Invokes the callback registered for event->type, if any.
+ */
+void glps_events_dispatch(glps_WindowManager *wm, const glps_Event *event);
+
+/**
+ * @brief Queues the event and dispatches it to its callback.
+ */
+void glps_events_emit(glps_WindowManager *wm, const glps_Event *event);
+
+/**
+ * @brief Invokes the window present callback, if any. Like frame updates,
+ *        presentation feedback is not queued.
+ */
+void glps_events_dispatch_present(glps_WindowManager *wm, size_t window_id,
+                                  const glps_PresentFeedback *feedback);
+
+/**
+ * @brief Invokes the frame update callback, if any, and counts the frame
+ *        against the window's schedule. Every backend render trigger goes
+ *        through here.
+ */
+void glps_events_dispatch_frame(glps_WindowManager *wm, size_t window_id);
+
+/**
+ * @brief Records the visibility of a window in its schedule and emits a
+ *        GLPS_EVENT_WINDOW_VISIBILITY if it changed.
+ */
+void glps_events_emit_visibility(glps_WindowManager *wm, size_t window_id,
+                                 GLPS_VISIBILITY visibility, uint64_t timestamp_ns);
+
+/**
+ * @brief Records the size from a configure event. Nothing is emitted until
+ *        glps_events_flush_resize(); a size equal to the one last delivered
+ *        cancels the pending resize.
+ * @return true if a resize is pending.
+ */
+bool glps_events_queue_resize(glps_WindowManager *wm, size_t window_id,
+                              glps_ResizeState *resize, int width, int height);
+
+/**
+ * @brief Emits the pending GLPS_EVENT_WINDOW_RESIZE, if any.
+ * @return true if one was emitted.
+ */
+bool glps_events_flush_resize(glps_WindowManager *wm, size_t window_id, glps_ResizeState *resize);
+
+/**
+ * @brief Emits a GLPS_EVENT_KEY. The callback receives text untruncated,
+ *        except when the event was read on the input thread.
+ */
+void glps_events_emit_key(glps_WindowManager *wm, size_t window_id, bool state,
+                          const char *text, unsigned long keycode, uint64_t timestamp_ns);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef GLPS_HEADLESS_H
+#define GLPS_HEADLESS_H
+
+#include "glps_common.h"
+
+/**
+ * @file glps_headless.h
+ * @brief Backend without a display server, for CI, thumbnails and batch
+ *        rendering.
+ *
+ * EGL is opened on EGL_MESA_platform_surfaceless, which Mesa offers even on
+ * llvmpipe without a GPU, or on the first device of EGL_EXT_platform_device.
+ * Every window is a pbuffer of the requested size held in the backend's own
+ * window struct, so the generic code reaches its schedule, present state and
+ * size as usual. There is no input and nothing to wait for, so windows render
+ * uncapped unless given a target rate.
+ */
+
+bool glps_headless_init(glps_WindowManager *wm);
+ssize_t glps_headless_window_create(glps_WindowManager *wm, const char *title,
+                                    int width, int height, const glps_SurfaceConfig *config);
+void glps_headless_window_update(glps_WindowManager *wm, size_t window_id);
+void glps_headless_window_destroy(glps_WindowManager *wm, size_t window_id);
+bool glps_headless_should_close(glps_WindowManager *wm);
+bool glps_headless_wait_events(glps_WindowManager *wm, int64_t timeout_ns);
+void glps_headless_destroy(glps_WindowManager *wm);
+
+#endif
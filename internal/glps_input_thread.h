@@ -0,0 +1,76 @@
+#ifndef GLPS_INPUT_THREAD_H
+#define GLPS_INPUT_THREAD_H
+
+#include "glps_common.h"
+#include "glps_spsc.h"
+#include "glps_thread.h"
+
+/**
+ * @file glps_input_thread.h
+ * @brief Optional thread that reads backend events off the render thread.
+ *
+ * The backend supplies the thread body. It reads events as soon as they
+ * arrive and pushes them into an SPSC ring; the render thread pops them in
+ * glps_wm_should_close() / glps_wm_dispatch_pending() and delivers them
+ * through the usual path. On X11 the ring carries raw XEvents so the drain
+ * can still coalesce them; on Wayland the seat listeners run on the input
+ * thread and the ring carries decoded glps_Events. Window creation and
+ * destruction stay on the render thread.
+ */
+
+struct glps_InputThread {
+    glps_WindowManager *wm;
+    gthread_t thread;
+    gthread_mutex_t lock;    /**< Guards native handle lookups shared with the render thread. */
+    atomic_bool running;
+    glps_SpscRing ring;
+    atomic_uint_fast64_t overflows;
+#ifdef GLPS_USE_WAYLAND
+    struct wl_event_queue *queue; /**< Seat objects are dispatched from here. */
+    int stop_fd;             /**< Wakes the thread to stop or rebind the seat. */
+    atomic_bool seat_dirty;  /**< Seat devices must be rebound on the thread. */
+#endif
+#ifdef GLPS_USE_X11
+    Window wake_window;      /**< Receives the stop message. */
+    Atom stop_atom;
+#endif
+};
+
+bool glps_input_thread_start(glps_WindowManager *wm, size_t capacity);
+void glps_input_thread_stop(glps_WindowManager *wm);
+
+/**
+ * @brief Called first thing by the backend thread body.
+ */
+void glps_input_thread_enter(glps_WindowManager *wm);
+
+/**
+ * @brief True if the calling thread is the input thread of wm.
+ */
+bool glps_input_thread_is_current(glps_WindowManager *wm);
+
+/**
+ * @brief Pushes an element from the input thread.
+ *
+ * A droppable element (pointer motion) is only queued while a quarter of the
+ * ring is still free; otherwise it counts an overflow and returns false.
+ * Any other element waits for room, waking the render thread, and only
+ * returns false if the thread is stopping with the ring still full.
+ */
+bool glps_input_thread_push(glps_WindowManager *wm, const void *element, bool droppable);
+
+/**
+ * @brief Pops an element on the render thread.
+ */
+bool glps_input_thread_pop(glps_WindowManager *wm, void *element);
+size_t glps_input_thread_pending(glps_WindowManager *wm);
+uint64_t glps_input_thread_overflows(glps_WindowManager *wm);
+
+/**
+ * @brief Serialize access to state shared with the input thread. No-ops
+ *        while the input thread is not running.
+ */
+void glps_input_thread_lock(glps_WindowManager *wm);
+void glps_input_thread_unlock(glps_WindowManager *wm);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef GLPS_LATENCY_H
+#define GLPS_LATENCY_H
+
+#include "glps_common.h"
+
+/**
+ * @file glps_latency.h
+ * @brief Event timestamps and input-to-swap latency probes.
+ *
+ * Backends stamp every event with CLOCK_MONOTONIC nanoseconds. Server
+ * timestamps (X11 Time, Wayland event time) are 32-bit milliseconds on an
+ * unspecified clock; they are mapped onto the monotonic clock with the
+ * smallest offset observed so far, which is the sample with the least
+ * delivery delay. Events without a server time are stamped when read.
+ */
+
+uint64_t glps_latency_now_ns(void);
+
+/**
+ * @brief Converts a server millisecond timestamp to CLOCK_MONOTONIC ns.
+ *        Must only be called from the thread that reads input.
+ */
+uint64_t glps_latency_from_server_ms(glps_WindowManager *wm, uint32_t time_ms);
+
+/**
+ * @brief Starts a latency sample for the event's window if none is pending.
+ */
+void glps_latency_mark_input(glps_WindowManager *wm, const glps_Event *event);
+
+/**
+ * @brief Closes the pending sample of a window; call once its swap returned.
+ */
+void glps_latency_record_swap(glps_WindowManager *wm, size_t window_id);
+
+#endif
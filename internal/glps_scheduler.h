@@ -0,0 +1,115 @@
+#ifndef GLPS_SCHEDULER_H
+#define GLPS_SCHEDULER_H
+
+#include "glps_common.h"
+
+/**
+ * @file glps_scheduler.h
+ * @brief Per-window frame pacing.
+ *
+ * Every window paces its frame update callback on its own schedule: at the
+ * refresh rate of the monitor it is on (GLPS_FPS_DISPLAY), at a fixed
+ * target rate, or not at all (GLPS_FPS_UNCAPPED). Backends report the
+ * monitor refresh interval as windows move between monitors and either
+ * sleep until the deadline or hold back compositor frame requests that
+ * arrive early. Deadlines advance by whole frames so jitter does not
+ * accumulate, and restart from the current time after a stall.
+ */
+
+#define GLPS_SCHEDULER_DEFAULT_REFRESH_NS (1000000000ull / 60)
+// Time the compositor or driver needs between a swap and the vblank.
+#define GLPS_SCHEDULER_LATCH_MARGIN_NS 1000000ull
+// Render durations needed before frame starts are delayed at all.
+#define GLPS_SCHEDULER_MIN_RENDER_SAMPLES 8
+// Percentile of recent render durations used as the estimate.
+#define GLPS_SCHEDULER_RENDER_PERCENTILE 90
+
+void glps_scheduler_init(glps_FrameSchedule *schedule);
+void glps_scheduler_set_target(glps_FrameSchedule *schedule, double fps);
+
+/**
+ * @brief Records the refresh interval of the window's monitor.
+ * @return true if it changed, in which case the schedule restarts.
+ */
+bool glps_scheduler_set_refresh(glps_FrameSchedule *schedule, uint64_t refresh_ns);
+
+/**
+ * @brief Refresh interval, or 60 Hz while unknown.
+ */
+uint64_t glps_scheduler_refresh_ns(const glps_FrameSchedule *schedule);
+
+/**
+ * @brief Time between frames, 0 when uncapped.
+ */
+uint64_t glps_scheduler_interval_ns(const glps_FrameSchedule *schedule);
+
+/**
+ * @brief True if a frame requested by the display at now_ns is due. Allows
+ *        half a refresh of slack so a request arriving just before the
+ *        deadline is not pushed to the next refresh.
+ */
+bool glps_scheduler_is_due(const glps_FrameSchedule *schedule, uint64_t now_ns);
+
+/**
+ * @brief Marks a frame as started at now_ns and sets the next deadline.
+ */
+void glps_scheduler_advance(glps_FrameSchedule *schedule, uint64_t now_ns);
+
+/**
+ * @brief Sleeps until an absolute CLOCK_MONOTONIC time.
+ */
+void glps_scheduler_sleep_until(uint64_t deadline_ns);
+
+/**
+ * @brief Sleeps until the next deadline, then advances the schedule.
+ */
+void glps_scheduler_wait(glps_FrameSchedule *schedule);
+
+/**
+ * @brief Predicts when the next frame is shown and sleeps until rendering
+ *        has to start to make it, so input is sampled as late as possible.
+ *
+ * The frame is expected on the first vblank after now plus the estimated
+ * render time; vblanks are extrapolated from last_present_ns (0 if
+ * unknown). The estimate is a high percentile of the durations recorded
+ * by glps_scheduler_end_render(); until enough are recorded, a full
+ * refresh is assumed and the call does not sleep.
+ */
+void glps_scheduler_begin_render(glps_FrameSchedule *schedule, uint64_t last_present_ns,
+                                 glps_FrameDeadline *deadline);
+
+/**
+ * @brief Records the duration of a frame started with glps_scheduler_begin_render().
+ */
+void glps_scheduler_end_render(glps_FrameSchedule *schedule);
+
+/**
+ * @brief Earliest time the window has a frame to render, or 0 if it waits
+ *        for an event. Continuous windows and pending redraws are due now,
+ *        on-demand windows at their redraw timer, and windows that are not
+ *        visible are further limited to their hidden rate.
+ */
+uint64_t glps_scheduler_next_frame_at(const glps_FrameSchedule *schedule, uint64_t now_ns);
+
+/**
+ * @brief True if glps_scheduler_next_frame_at() has been reached.
+ */
+bool glps_scheduler_wants_frame(const glps_FrameSchedule *schedule, uint64_t now_ns);
+
+/**
+ * @brief Records a visibility change.
+ * @return true if the visibility changed.
+ */
+bool glps_scheduler_set_visibility(glps_FrameSchedule *schedule, GLPS_VISIBILITY visibility);
+
+/**
+ * @brief Makes an on-demand window render its next frame.
+ */
+void glps_scheduler_request_redraw(glps_FrameSchedule *schedule);
+
+/**
+ * @brief Records a rendered frame and consumes the pending redraw.
+ */
+void glps_scheduler_frame_done(glps_FrameSchedule *schedule, uint64_t now_ns);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef GLPS_SPSC_H
+#define GLPS_SPSC_H
+
+#include "glps_common.h"
+
+#include <stdatomic.h>
+
+/**
+ * @file glps_spsc.h
+ * @brief Lock-free single-producer/single-consumer ring of fixed-size elements.
+ *
+ * One thread may push and one other thread may pop concurrently without
+ * locks. Push never blocks: it fails when the ring is full and the caller
+ * decides what to do with the element.
+ */
+
+#define GLPS_CACHE_LINE_SIZE 64
+
+typedef struct {
+    unsigned char *buffer;
+    size_t element_size;
+    size_t capacity; /**< Power of two. */
+    _Alignas(GLPS_CACHE_LINE_SIZE) atomic_size_t head; /**< Written by the consumer. */
+    _Alignas(GLPS_CACHE_LINE_SIZE) atomic_size_t tail; /**< Written by the producer. */
+} glps_SpscRing;
+
+bool glps_spsc_init(glps_SpscRing *ring, size_t element_size, size_t capacity);
+void glps_spsc_destroy(glps_SpscRing *ring);
+
+/**
+ * @brief Copies element into the ring. Producer thread only.
+ * @return False if the ring is full.
+ */
+bool glps_spsc_push(glps_SpscRing *ring, const void *element);
+
+/**
+ * @brief Copies the oldest element out of the ring. Consumer thread only.
+ * @return False if the ring is empty.
+ */
+bool glps_spsc_pop(glps_SpscRing *ring, void *element);
+
+/**
+ * @brief Number of elements the consumer can pop right now.
+ */
+size_t glps_spsc_size(glps_SpscRing *ring);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef GLPS_WAKEUP_H
+#define GLPS_WAKEUP_H
+
+#include "glps_common.h"
+
+/**
+ * @file glps_wakeup.h
+ * @brief eventfd used to interrupt a blocking wait from another thread.
+ *
+ * Backends poll wm->wakeup_fd next to the display connection. Posting is a
+ * single write() and is safe from any thread; the waiting thread drains the
+ * counter once it wakes up.
+ */
+
+bool glps_wakeup_init(glps_WindowManager *wm);
+void glps_wakeup_destroy(glps_WindowManager *wm);
+void glps_wakeup_post(glps_WindowManager *wm);
+void glps_wakeup_drain(glps_WindowManager *wm);
+
+/**
+ * @brief Converts a timeout in nanoseconds to poll() milliseconds, rounding up.
+ *        Negative values mean no timeout.
+ */
+int glps_wakeup_timeout_ms(int64_t timeout_ns);
+
+#endif
@@ -138,10 +138,30 @@ bool glps_wl_init(glps_WindowManager *wm);
 
 ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
                               int x, int y, int width, int height);
+ssize_t glps_wl_window_create_ex(glps_WindowManager *wm, const char *title,
+                                 int x, int y, int width, int height,
+                                 const glps_SurfaceConfig *config);
 
 void glps_wl_window_is_resizable(glps_WindowManager *wm, bool state, size_t window_id);
 
 bool glps_wl_should_close(glps_WindowManager *wm);
+bool glps_wl_wait_events(glps_WindowManager *wm, int64_t timeout_ns);
+bool glps_wl_prepare(glps_WindowManager *wm);
+bool glps_wl_dispatch_pending(glps_WindowManager *wm);
+int64_t glps_wl_next_timeout_ns(glps_WindowManager *wm);
+void glps_wl_update_seat_capabilities(glps_WindowManager *wm);
+/**
+ * @brief Arms the frame callback and a presentation feedback request for the
+ *        next commit of the window. Call right before every commit.
+ */
+void glps_wl_prepare_commit(glps_WindowManager *wm, size_t window_id);
+void glps_wl_window_set_present_mode(glps_WindowManager *wm, size_t window_id);
+void glps_wl_enable_window_queues(glps_WindowManager *wm, bool enable);
+bool glps_wl_window_dispatch(glps_WindowManager *wm, size_t window_id, int64_t timeout_ns);
+bool glps_wl_input_thread_setup(glps_WindowManager *wm);
+void *glps_wl_input_thread_run(void *arg);
+void glps_wl_input_thread_wake(glps_WindowManager *wm);
+void glps_wl_input_thread_teardown(glps_WindowManager *wm);
 
 void glps_wl_window_destroy(glps_WindowManager *wm, size_t window_id);
 void glps_wl_cursor_change(glps_WindowManager* wm, GLPS_CURSOR_TYPE user_cursor);
@@ -0,0 +1,22 @@
+#ifndef GLPS_WINDOW_INDEX_H
+#define GLPS_WINDOW_INDEX_H
+
+#include "glps_common.h"
+
+/**
+ * @file glps_window_index.h
+ * @brief Hashed lookup from native handles (XID, Wayland proxies) to window IDs.
+ *
+ * Backends register every native handle they receive events for when a window
+ * is created and drop it when the window is destroyed, so event dispatch can
+ * resolve the target window in O(1) instead of scanning wm->windows. Lookups
+ * are serialized with the input thread when it is running.
+ */
+
+bool glps_window_index_add(glps_WindowManager *wm, uintptr_t key, size_t window_id);
+ssize_t glps_window_index_find(glps_WindowManager *wm, uintptr_t key);
+void glps_window_index_update(glps_WindowManager *wm, uintptr_t key, size_t window_id);
+void glps_window_index_remove(glps_WindowManager *wm, uintptr_t key);
+void glps_window_index_clear(glps_WindowManager *wm);
+
+#endif
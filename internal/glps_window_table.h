@@ -0,0 +1,68 @@
+#ifndef GLPS_WINDOW_TABLE_H
+#define GLPS_WINDOW_TABLE_H
+
+#include "glps_common.h"
+
+/**
+ * @file glps_window_table.h
+ * @brief Growable slot map backing wm->windows.
+ *
+ * A window ID is a handle made of a slot index (low bits) and the slot's
+ * generation (high bits). Freed slots are recycled through a free list and
+ * their generation is bumped, so IDs held by the application or captured by
+ * callbacks never get renumbered, and stale IDs are rejected instead of
+ * aliasing a newer window. The first window created in a fresh slot has
+ * generation 0, so its ID is the plain slot index.
+ */
+
+#if SIZE_MAX > 0xFFFFFFFFu
+#define GLPS_WINDOW_SLOT_BITS 32
+#else
+#define GLPS_WINDOW_SLOT_BITS 16
+#endif
+
+#define GLPS_WINDOW_SLOT_MASK (((size_t)1 << GLPS_WINDOW_SLOT_BITS) - 1)
+// One bit is left clear so a handle never reads as negative through ssize_t.
+#define GLPS_WINDOW_GENERATION_MASK (SIZE_MAX >> (GLPS_WINDOW_SLOT_BITS + 1))
+#define GLPS_WINDOW_SLOT(window_id) ((size_t)(window_id) & GLPS_WINDOW_SLOT_MASK)
+#define GLPS_WINDOW_GENERATION(window_id) ((uint32_t)((size_t)(window_id) >> GLPS_WINDOW_SLOT_BITS))
+#define GLPS_WINDOW_HANDLE(slot, generation) \
+    (((size_t)(generation) << GLPS_WINDOW_SLOT_BITS) | ((size_t)(slot) & GLPS_WINDOW_SLOT_MASK))
+
+#define GLPS_WINDOW_TABLE_INITIAL_CAPACITY 8
+
+bool glps_window_table_init(glps_WindowManager *wm);
+void glps_window_table_destroy(glps_WindowManager *wm);
+
+/**
+ * @brief Stores a window in a free slot, growing the table if needed.
+ * @return The window ID, or -1 on allocation failure.
+ */
+ssize_t glps_window_table_insert(glps_WindowManager *wm, void *window);
+
+/**
+ * @brief Releases the slot of a window in O(1). The caller frees the window.
+ */
+void glps_window_table_remove(glps_WindowManager *wm, size_t window_id);
+
+/**
+ * @brief Returns true if window_id refers to a live window of this generation.
+ */
+bool glps_window_table_is_live(glps_WindowManager *wm, size_t window_id);
+
+/**
+ * @brief Returns the window stored for window_id, or NULL if the ID is stale.
+ */
+void *glps_window_table_get(glps_WindowManager *wm, size_t window_id);
+
+/**
+ * @brief Number of slots, live or free. Use with glps_window_table_id_at().
+ */
+size_t glps_window_table_capacity(glps_WindowManager *wm);
+
+/**
+ * @brief Returns the ID of the window in a slot, or -1 if the slot is free.
+ */
+ssize_t glps_window_table_id_at(glps_WindowManager *wm, size_t slot);
+
+#endif
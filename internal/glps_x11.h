@@ -3,11 +3,12 @@
 
 #include "glps_common.h"
 
-void glps_x11_init(glps_WindowManager *wm);
+bool glps_x11_init(glps_WindowManager *wm);
 
 ssize_t glps_x11_window_create(glps_WindowManager *wm, const char *title,
                                int x, int y, int width, int height);
 
+void glps_x11_window_destroy(glps_WindowManager *wm, size_t window_id);
 void glps_x11_destroy(glps_WindowManager *wm);
 void glps_x11_get_window_dimensions(glps_WindowManager *wm, size_t window_id,
                                     int *width, int *height);
@@ -19,7 +20,16 @@ void glps_x11_get_from_clipboard(glps_WindowManager *wm, char *data,
                                  size_t data_size);
 
 bool glps_x11_should_close(glps_WindowManager *wm);
+bool glps_x11_wait_events(glps_WindowManager *wm, int64_t timeout_ns);
+bool glps_x11_prepare(glps_WindowManager *wm);
+bool glps_x11_dispatch_pending(glps_WindowManager *wm);
+void glps_x11_update_input_mask(glps_WindowManager *wm);
+bool glps_x11_input_thread_setup(glps_WindowManager *wm);
+void *glps_x11_input_thread_run(void *arg);
+void glps_x11_input_thread_wake(glps_WindowManager *wm);
+void glps_x11_input_thread_teardown(glps_WindowManager *wm);
 void glps_x11_window_update(glps_WindowManager *wm, size_t window_id);
+void glps_x11_after_swap(glps_WindowManager *wm, size_t window_id);
 void glps_x11_window_is_resizable(glps_WindowManager *wm, bool state, size_t window_id);
 void glps_x11_toggle_window_decorations(glps_WindowManager *wm, bool state, size_t window_id);
 void glps_x11_cursor_change(glps_WindowManager *wm, GLPS_CURSOR_TYPE user_cursor);
@@ -32,7 +42,8 @@ ssize_t glps_x11_window_create_ex(
     const char *title,
     int x, int y,
     int width, int height,
-    GLPS_WindowFlags flags
+    GLPS_WindowFlags flags,
+    const glps_SurfaceConfig *config
 );
 void glps_x11_move_window(
     glps_WindowManager *wm,
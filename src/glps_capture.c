@@ -0,0 +1,505 @@
+#include "glps_capture.h"
+#include "glps_latency.h"
+#include "glps_spsc.h"
+#include "glps_thread.h"
+#include "glps_window_table.h"
+#include "utils/logger/pico_logger.h"
+
+#include <GLES3/gl3.h>
+#include <math.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+#define GLPS_CAPTURE_STOP_TIMEOUT_NS 100000000ull
+
+typedef struct {
+    GLuint pbo;
+    GLsync fence;
+    size_t size; /**< Bytes allocated for pbo. */
+    int width, height;
+    uint64_t index;
+    uint64_t timestamp_ns;
+    bool late;   /**< Already counted in late_frames. */
+} glps_CaptureReadback;
+
+typedef struct {
+    uint8_t *pixels; /**< RGBA8, top row first. */
+    size_t size;
+    int width, height;
+    uint64_t index;
+    uint64_t timestamp_ns;
+} glps_CaptureBuffer;
+
+struct glps_Capture {
+    size_t window_id;
+    glps_CaptureSink sink;
+    FILE *file;
+
+    // Render thread
+    glps_CaptureReadback ring[GLPS_CAPTURE_RING_SIZE];
+    size_t ring_head, ring_count;
+    uint64_t next_index;
+    bool warned_surface;
+    glps_CaptureStats stats;
+
+    // Shared with the capture thread
+    glps_CaptureBuffer buffers[GLPS_CAPTURE_QUEUE_SIZE];
+    glps_SpscRing queued;       /**< Buffer indices, render -> capture thread. */
+    glps_SpscRing free_buffers; /**< Buffer indices, capture thread -> render. */
+    gthread_t thread;
+    gthread_mutex_t lock;
+    gthread_cond_t cond;
+    bool running; /**< Guarded by lock. */
+    atomic_uint_fast64_t frames_written;
+    atomic_uint_fast64_t dropped_size;
+
+    // Capture thread
+    int stream_width, stream_height; /**< Size in the Y4M header, 0 until written. */
+    uint8_t *yuv;
+    size_t yuv_size;
+};
+
+static struct glps_Capture **__capture_slot(glps_WindowManager *wm, size_t window_id)
+{
+    if (!glps_window_table_is_live(wm, window_id)) return NULL;
+
+    return &wm->windows[GLPS_WINDOW_SLOT(window_id)]->capture;
+}
+
+static uint8_t __clamp_u8(int value)
+{
+    return (uint8_t)(value < 0 ? 0 : value > 255 ? 255 : value);
+}
+
+static bool __write_y4m(struct glps_Capture *capture, const glps_CaptureBuffer *buffer)
+{
+    int w = buffer->width, h = buffer->height;
+
+    if (capture->stream_width == 0)
+    {
+        double fps = capture->sink.fps > 0.0 ? capture->sink.fps : 60.0;
+        fprintf(capture->file, "YUV4MPEG2 W%d H%d F%ld:1000 Ip A1:1 C420jpeg\n",
+                w, h, lround(fps * 1000.0));
+        capture->stream_width = w;
+        capture->stream_height = h;
+    }
+    else if (w != capture->stream_width || h != capture->stream_height)
+    {
+        return false;
+    }
+
+    int cw = (w + 1) / 2, ch = (h + 1) / 2;
+    size_t size = (size_t)w * h + 2 * (size_t)cw * ch;
+    if (capture->yuv_size < size)
+    {
+        uint8_t *yuv = realloc(capture->yuv, size);
+        if (yuv == NULL)
+        {
+            LOG_ERROR("Failed to allocate Y4M frame");
+            return false;
+        }
+        capture->yuv = yuv;
+        capture->yuv_size = size;
+    }
+
+    // Full range BT.601 (JFIF), chroma averaged over each 2x2 block.
+    uint8_t *y_plane = capture->yuv;
+    uint8_t *u_plane = y_plane + (size_t)w * h;
+    uint8_t *v_plane = u_plane + (size_t)cw * ch;
+    size_t stride = (size_t)w * 4;
+
+    for (int y = 0; y < h; y++)
+    {
+        const uint8_t *row = buffer->pixels + y * stride;
+        for (int x = 0; x < w; x++, row += 4)
+            y_plane[(size_t)y * w + x] = (uint8_t)((77 * row[0] + 150 * row[1] + 29 * row[2] + 128) >> 8);
+    }
+
+    for (int cy = 0; cy < ch; cy++)
+    {
+        const uint8_t *top = buffer->pixels + (size_t)(2 * cy) * stride;
+        const uint8_t *bottom = 2 * cy + 1 < h ? top + stride : top;
+
+        for (int cx = 0; cx < cw; cx++)
+        {
+            size_t left = (size_t)(2 * cx) * 4;
+            size_t right = 2 * cx + 1 < w ? left + 4 : left;
+            int r = top[left] + top[right] + bottom[left] + bottom[right];
+            int g = top[left + 1] + top[right + 1] + bottom[left + 1] + bottom[right + 1];
+            int b = top[left + 2] + top[right + 2] + bottom[left + 2] + bottom[right + 2];
+
+            // Sums of four samples: shift by 10 instead of 8, offset 128 << 10.
+            u_plane[(size_t)cy * cw + cx] = __clamp_u8((-43 * r - 85 * g + 128 * b + 131584) >> 10);
+            v_plane[(size_t)cy * cw + cx] = __clamp_u8((128 * r - 107 * g - 21 * b + 131584) >> 10);
+        }
+    }
+
+    return fwrite("FRAME\n", 1, 6, capture->file) == 6 &&
+           fwrite(capture->yuv, 1, size, capture->file) == size;
+}
+
+static bool __write_frame(struct glps_Capture *capture, const glps_CaptureBuffer *buffer)
+{
+    size_t stride = (size_t)buffer->width * 4;
+
+    switch (capture->sink.type)
+    {
+    case GLPS_CAPTURE_SINK_CALLBACK:
+    {
+        glps_CaptureFrame frame = {
+            .window_id = capture->window_id,
+            .width = buffer->width,
+            .height = buffer->height,
+            .stride = stride,
+            .pixels = buffer->pixels,
+            .index = buffer->index,
+            .timestamp_ns = buffer->timestamp_ns,
+        };
+        capture->sink.callback(&frame, capture->sink.data);
+        return true;
+    }
+    case GLPS_CAPTURE_SINK_Y4M:
+        return __write_y4m(capture, buffer);
+    case GLPS_CAPTURE_SINK_RAW:
+    {
+        size_t size = stride * buffer->height;
+        return fwrite(buffer->pixels, 1, size, capture->file) == size;
+    }
+    }
+    return false;
+}
+
+static void *__capture_thread(void *arg)
+{
+    struct glps_Capture *capture = (struct glps_Capture *)arg;
+
+    for (;;)
+    {
+        glps_thread_mutex_lock(&capture->lock);
+        while (capture->running && glps_spsc_size(&capture->queued) == 0)
+            glps_thread_cond_wait(&capture->cond, &capture->lock);
+        bool stop = !capture->running && glps_spsc_size(&capture->queued) == 0;
+        glps_thread_mutex_unlock(&capture->lock);
+
+        if (stop) break;
+
+        size_t index;
+        while (glps_spsc_pop(&capture->queued, &index))
+        {
+            if (__write_frame(capture, &capture->buffers[index]))
+                atomic_fetch_add_explicit(&capture->frames_written, 1, memory_order_relaxed);
+            else
+                atomic_fetch_add_explicit(&capture->dropped_size, 1, memory_order_relaxed);
+            glps_spsc_push(&capture->free_buffers, &index);
+        }
+    }
+
+    return NULL;
+}
+
+static void __release(struct glps_Capture *capture)
+{
+    for (size_t i = 0; i < GLPS_CAPTURE_QUEUE_SIZE; i++)
+        free(capture->buffers[i].pixels);
+    free(capture->yuv);
+    glps_spsc_destroy(&capture->queued);
+    glps_spsc_destroy(&capture->free_buffers);
+    if (capture->file != NULL) fclose(capture->file);
+    free(capture);
+}
+
+/**
+ * Copies a finished readback into a free buffer of the capture thread. When
+ * stopping, waits for the thread to hand a buffer back instead of dropping.
+ */
+static void __deliver(struct glps_Capture *capture, const glps_CaptureReadback *readback, bool wait)
+{
+    size_t index;
+    while (!glps_spsc_pop(&capture->free_buffers, &index))
+    {
+        if (!wait)
+        {
+            capture->stats.dropped_sink++;
+            return;
+        }
+        sched_yield();
+    }
+
+    glps_CaptureBuffer *buffer = &capture->buffers[index];
+    size_t stride = (size_t)readback->width * 4;
+    size_t size = stride * readback->height;
+
+    if (buffer->size < size)
+    {
+        uint8_t *pixels = realloc(buffer->pixels, size);
+        if (pixels == NULL)
+        {
+            LOG_ERROR("Failed to allocate capture frame");
+            capture->stats.dropped_sink++;
+            glps_spsc_push(&capture->free_buffers, &index);
+            return;
+        }
+        buffer->pixels = pixels;
+        buffer->size = size;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+    const uint8_t *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size, GL_MAP_READ_BIT);
+    if (mapped == NULL)
+    {
+        LOG_ERROR("Failed to map capture buffer: 0x%x", glGetError());
+        capture->stats.dropped_sink++;
+        glps_spsc_push(&capture->free_buffers, &index);
+        return;
+    }
+
+    // GL rows start at the bottom.
+    for (int y = 0; y < readback->height; y++)
+        memcpy(buffer->pixels + (size_t)y * stride,
+               mapped + (size_t)(readback->height - 1 - y) * stride, stride);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+    buffer->width = readback->width;
+    buffer->height = readback->height;
+    buffer->index = readback->index;
+    buffer->timestamp_ns = readback->timestamp_ns;
+
+    // Nothing else pushes to queued, and it holds every buffer, so this cannot fail.
+    glps_spsc_push(&capture->queued, &index);
+    glps_thread_mutex_lock(&capture->lock);
+    glps_thread_cond_signal(&capture->cond);
+    glps_thread_mutex_unlock(&capture->lock);
+}
+
+/**
+ * Retires readbacks in the order they were issued. Without wait, stops at the
+ * first one the GPU has not finished.
+ */
+static void __collect(struct glps_Capture *capture, bool wait)
+{
+    if (capture->ring_count == 0) return;
+
+    GLint pack_buffer = 0;
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &pack_buffer);
+
+    while (capture->ring_count > 0)
+    {
+        glps_CaptureReadback *readback = &capture->ring[capture->ring_head];
+        GLenum status = glClientWaitSync(readback->fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                         wait ? GLPS_CAPTURE_STOP_TIMEOUT_NS : 0);
+
+        if (status == GL_TIMEOUT_EXPIRED && !wait)
+        {
+            if (!readback->late)
+            {
+                readback->late = true;
+                capture->stats.late_frames++;
+            }
+            break;
+        }
+
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+        {
+            __deliver(capture, readback, wait);
+        }
+        else
+        {
+            LOG_ERROR("Capture readback did not complete: 0x%x", glGetError());
+            capture->stats.dropped_gpu++;
+        }
+
+        glDeleteSync(readback->fence);
+        readback->fence = NULL;
+        capture->ring_head = (capture->ring_head + 1) % GLPS_CAPTURE_RING_SIZE;
+        capture->ring_count--;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)pack_buffer);
+}
+
+bool glps_capture_start(glps_WindowManager *wm, size_t window_id, const glps_CaptureSink *sink)
+{
+    struct glps_Capture **slot = __capture_slot(wm, window_id);
+    if (slot == NULL || sink == NULL) return false;
+
+    if (*slot != NULL)
+    {
+        LOG_WARNING("Window %zu is already being captured.", window_id);
+        return false;
+    }
+
+    if (sink->type == GLPS_CAPTURE_SINK_CALLBACK ? sink->callback == NULL : sink->path == NULL)
+    {
+        LOG_ERROR("Capture sink needs a %s.", sink->type == GLPS_CAPTURE_SINK_CALLBACK ? "callback" : "path");
+        return false;
+    }
+
+    struct glps_Capture *capture = (struct glps_Capture *)calloc(1, sizeof(*capture));
+    if (capture == NULL)
+    {
+        LOG_ERROR("Failed to allocate capture");
+        return false;
+    }
+    capture->window_id = window_id;
+    capture->sink = *sink;
+    capture->sink.path = NULL; // Only needed here; the caller owns the string.
+    atomic_init(&capture->frames_written, 0);
+    atomic_init(&capture->dropped_size, 0);
+
+    if (!glps_spsc_init(&capture->queued, sizeof(size_t), GLPS_CAPTURE_QUEUE_SIZE) ||
+        !glps_spsc_init(&capture->free_buffers, sizeof(size_t), GLPS_CAPTURE_QUEUE_SIZE))
+    {
+        __release(capture);
+        return false;
+    }
+    for (size_t i = 0; i < GLPS_CAPTURE_QUEUE_SIZE; i++)
+        glps_spsc_push(&capture->free_buffers, &i);
+
+    if (sink->type != GLPS_CAPTURE_SINK_CALLBACK && (capture->file = fopen(sink->path, "wb")) == NULL)
+    {
+        LOG_ERROR("Failed to open capture file %s", sink->path);
+        __release(capture);
+        return false;
+    }
+
+    glps_thread_mutex_init(&capture->lock, NULL);
+    glps_thread_cond_init(&capture->cond, NULL);
+    capture->running = true;
+
+    if (glps_thread_create(&capture->thread, NULL, __capture_thread, capture) != 0)
+    {
+        LOG_ERROR("Failed to start capture thread");
+        glps_thread_cond_destroy(&capture->cond);
+        glps_thread_mutex_destroy(&capture->lock);
+        __release(capture);
+        return false;
+    }
+
+    *slot = capture;
+    return true;
+}
+
+void glps_capture_stop(glps_WindowManager *wm, size_t window_id, glps_CaptureStats *stats)
+{
+    struct glps_Capture **slot = __capture_slot(wm, window_id);
+    if (slot == NULL || *slot == NULL) return;
+
+    struct glps_Capture *capture = *slot;
+    *slot = NULL;
+
+    // GL objects can only be touched with the shared context current; without
+    // it they are left to the context and the frames in flight are lost.
+    if (wm->egl_ctx != NULL && eglGetCurrentContext() == wm->egl_ctx->ctx)
+    {
+        __collect(capture, true);
+        for (size_t i = 0; i < GLPS_CAPTURE_RING_SIZE; i++)
+            if (capture->ring[i].pbo != 0) glDeleteBuffers(1, &capture->ring[i].pbo);
+    }
+    else
+    {
+        capture->stats.dropped_gpu += capture->ring_count;
+    }
+
+    glps_thread_mutex_lock(&capture->lock);
+    capture->running = false;
+    glps_thread_cond_signal(&capture->cond);
+    glps_thread_mutex_unlock(&capture->lock);
+    glps_thread_join(capture->thread, NULL);
+
+    glps_thread_cond_destroy(&capture->cond);
+    glps_thread_mutex_destroy(&capture->lock);
+
+    if (stats != NULL)
+    {
+        *stats = capture->stats;
+        stats->frames_written = atomic_load(&capture->frames_written);
+        stats->dropped_size = atomic_load(&capture->dropped_size);
+    }
+
+    __release(capture);
+}
+
+void glps_capture_frame(glps_WindowManager *wm, size_t window_id)
+{
+    struct glps_Capture **slot = __capture_slot(wm, window_id);
+    if (slot == NULL || *slot == NULL || wm->egl_ctx == NULL) return;
+
+    struct glps_Capture *capture = *slot;
+    EGLSurface surface = wm->windows[GLPS_WINDOW_SLOT(window_id)]->egl_surface;
+
+    __collect(capture, false);
+
+    if (eglGetCurrentSurface(EGL_READ) != surface)
+    {
+        if (!capture->warned_surface)
+            LOG_WARNING("Window %zu is not current; its swaps are not captured.", window_id);
+        capture->warned_surface = true;
+        return;
+    }
+
+    uint64_t index = capture->next_index++;
+    if (capture->ring_count == GLPS_CAPTURE_RING_SIZE)
+    {
+        capture->stats.dropped_gpu++;
+        return;
+    }
+
+    EGLint width = 0, height = 0;
+    eglQuerySurface(wm->egl_ctx->dpy, surface, EGL_WIDTH, &width);
+    eglQuerySurface(wm->egl_ctx->dpy, surface, EGL_HEIGHT, &height);
+    if (width <= 0 || height <= 0) return;
+
+    glps_CaptureReadback *readback =
+        &capture->ring[(capture->ring_head + capture->ring_count) % GLPS_CAPTURE_RING_SIZE];
+    size_t size = (size_t)width * height * 4;
+
+    GLint pack_buffer = 0, read_framebuffer = 0, pack_alignment = 4;
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &pack_buffer);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_framebuffer);
+    glGetIntegerv(GL_PACK_ALIGNMENT, &pack_alignment);
+
+    if (readback->pbo == 0) glGenBuffers(1, &readback->pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+    if (readback->size != size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_READ);
+        readback->size = size;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, pack_alignment);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)read_framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)pack_buffer);
+
+    if (readback->fence == NULL)
+    {
+        LOG_ERROR("Failed to fence capture readback: 0x%x", glGetError());
+        capture->stats.dropped_gpu++;
+        return;
+    }
+
+    readback->width = width;
+    readback->height = height;
+    readback->index = index;
+    readback->timestamp_ns = glps_latency_now_ns();
+    readback->late = false;
+    capture->ring_count++;
+    capture->stats.frames_read++;
+}
+
+bool glps_capture_get_stats(glps_WindowManager *wm, size_t window_id, glps_CaptureStats *stats)
+{
+    struct glps_Capture **slot = __capture_slot(wm, window_id);
+    if (slot == NULL || *slot == NULL || stats == NULL) return false;
+
+    struct glps_Capture *capture = *slot;
+    *stats = capture->stats;
+    stats->frames_written = atomic_load(&capture->frames_written);
+    stats->dropped_size = atomic_load(&capture->dropped_size);
+    return true;
+}
@@ -1,55 +1,234 @@
 
 #include <glps_egl_context.h>
+#include "glps_window_table.h"
 #include "utils/logger/pico_logger.h"
 
-void glps_egl_init(glps_WindowManager *wm, EGLNativeDisplayType display) {
+// Most damage lists are a handful of widgets; longer ones are full frames.
+#define MAX_DAMAGE_RECTS 32
 
+// Binding this thread last made through GLPS. eglMakeCurrent() flushes even
+// when nothing changes, so requests for the same binding are skipped.
+static _Thread_local struct {
+  EGLDisplay dpy;
+  EGLSurface surface;
+  EGLContext ctx;
+  size_t window_id;
+} __current = {EGL_NO_DISPLAY, EGL_NO_SURFACE, EGL_NO_CONTEXT, 0};
 
+bool glps_egl_has_extension(const char *extensions, const char *name) {
+  size_t length = strlen(name);
+  for (const char *p = extensions; p != NULL && (p = strstr(p, name)) != NULL; p += length) {
+    if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+      return true;
+  }
+  return false;
+}
+
+static void __load_extensions(glps_EGLContext *egl) {
+  const char *extensions = eglQueryString(egl->dpy, EGL_EXTENSIONS);
+
+  if (glps_egl_has_extension(extensions, "EGL_KHR_swap_buffers_with_damage"))
+    egl->swap_buffers_with_damage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress(
+        "eglSwapBuffersWithDamageKHR");
+  else if (glps_egl_has_extension(extensions, "EGL_EXT_swap_buffers_with_damage"))
+    egl->swap_buffers_with_damage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress(
+        "eglSwapBuffersWithDamageEXT");
+  egl->has_buffer_age = glps_egl_has_extension(extensions, "EGL_EXT_buffer_age");
+  egl->has_no_config_context = glps_egl_has_extension(extensions, "EGL_KHR_no_config_context");
+  egl->has_gl_colorspace = glps_egl_has_extension(extensions, "EGL_KHR_gl_colorspace");
+
+  if (egl->swap_buffers_with_damage == NULL)
+    LOG_INFO("EGL swap with damage unavailable, presenting full frames.");
+}
+
+static bool __same_format(const glps_SurfaceConfig *a, const glps_SurfaceConfig *b) {
+  return a->red_bits == b->red_bits && a->green_bits == b->green_bits &&
+         a->blue_bits == b->blue_bits && a->alpha_bits == b->alpha_bits &&
+         a->depth_bits == b->depth_bits && a->stencil_bits == b->stencil_bits &&
+         a->samples == b->samples && a->srgb == b->srgb;
+}
+
+static EGLint __config_attrib(EGLDisplay dpy, EGLConfig config, EGLint attrib) {
+  EGLint value = 0;
+  eglGetConfigAttrib(dpy, config, attrib, &value);
+  return value;
+}
+
+// eglChooseConfig() sorts deeper formats first; every bit beyond the request
+// costs bandwidth, so the config closest to the request scores lowest.
+static long __score_config(EGLDisplay dpy, EGLConfig config, const glps_SurfaceConfig *want) {
+  int samples = want->samples > 1 ? want->samples : 0;
+  long score = 0;
+
+  score += __config_attrib(dpy, config, EGL_RED_SIZE) - want->red_bits;
+  score += __config_attrib(dpy, config, EGL_GREEN_SIZE) - want->green_bits;
+  score += __config_attrib(dpy, config, EGL_BLUE_SIZE) - want->blue_bits;
+  score += __config_attrib(dpy, config, EGL_ALPHA_SIZE) - want->alpha_bits;
+  score += __config_attrib(dpy, config, EGL_DEPTH_SIZE) - want->depth_bits;
+  score += __config_attrib(dpy, config, EGL_STENCIL_SIZE) - want->stencil_bits;
+  // Each extra sample multiplies the color and depth traffic.
+  score += 16 * (__config_attrib(dpy, config, EGL_SAMPLES) - samples);
+  if (__config_attrib(dpy, config, EGL_CONFIG_CAVEAT) == EGL_SLOW_CONFIG)
+    score += 1000;
+
+  return score;
+}
+
+static EGLConfig __find_config(EGLDisplay dpy, EGLint surface_type, const glps_SurfaceConfig *want) {
+  int samples = want->samples > 1 ? want->samples : 0;
+  EGLint attribs[] = {EGL_SURFACE_TYPE,    surface_type,
+                      EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+                      EGL_RED_SIZE,        want->red_bits,
+                      EGL_GREEN_SIZE,      want->green_bits,
+                      EGL_BLUE_SIZE,       want->blue_bits,
+                      EGL_ALPHA_SIZE,      want->alpha_bits,
+                      EGL_DEPTH_SIZE,      want->depth_bits,
+                      EGL_STENCIL_SIZE,    want->stencil_bits,
+                      EGL_SAMPLE_BUFFERS,  samples > 0 ? 1 : 0,
+                      EGL_SAMPLES,         samples,
+                      EGL_NONE};
+  EGLint count = 0;
+
+  if (!eglChooseConfig(dpy, attribs, NULL, 0, &count) || count == 0)
+    return EGL_NO_CONFIG_KHR;
+
+  EGLConfig *configs = malloc((size_t)count * sizeof(*configs));
+  if (configs == NULL)
+    return EGL_NO_CONFIG_KHR;
+
+  EGLConfig best = EGL_NO_CONFIG_KHR;
+  if (eglChooseConfig(dpy, attribs, configs, count, &count)) {
+    long best_score = 0;
+    for (EGLint i = 0; i < count; ++i) {
+      long score = __score_config(dpy, configs[i], want);
+      if (best == EGL_NO_CONFIG_KHR || score < best_score) {
+        best = configs[i];
+        best_score = score;
+      }
+    }
+  }
+
+  free(configs);
+  return best;
+}
+
+EGLConfig glps_egl_choose_config(glps_WindowManager *wm, const glps_SurfaceConfig *format) {
+  glps_EGLContext *egl = wm->egl_ctx;
+  glps_SurfaceConfig want = format != NULL ? *format : GLPS_SURFACE_CONFIG_DEFAULT;
+  EGLConfig config = EGL_NO_CONFIG_KHR;
+
+  for (size_t i = 0; i < egl->config_count; ++i) {
+    if (__same_format(&egl->configs[i].format, &want)) {
+      config = egl->configs[i].config;
+      break;
+    }
+  }
+
+  if (config == EGL_NO_CONFIG_KHR) {
+    config = __find_config(egl->dpy, egl->surface_type, &want);
+    if (config == EGL_NO_CONFIG_KHR) {
+      LOG_ERROR("No EGL config for R%dG%dB%dA%d D%d S%d x%d", want.red_bits, want.green_bits,
+                want.blue_bits, want.alpha_bits, want.depth_bits, want.stencil_bits,
+                want.samples);
+      return EGL_NO_CONFIG_KHR;
+    }
+    if (egl->config_count < GLPS_EGL_CONFIG_CACHE_SIZE)
+      egl->configs[egl->config_count++] = (glps_EGLConfigEntry){want, config};
+  }
+
+  if (egl->has_no_config_context || config == egl->conf)
+    return config;
+
+  // Without EGL_KHR_no_config_context the context is bound to one config.
+  if (egl->ctx != EGL_NO_CONTEXT) {
+    LOG_WARNING("EGL_KHR_no_config_context unavailable, using the context's config.");
+    return egl->conf;
+  }
+  egl->conf = config;
+  return config;
+}
+
+// Appends the surface attributes of format at attribs, returns the count written.
+static size_t __surface_attribs(glps_WindowManager *wm, const glps_SurfaceConfig *format,
+                                EGLint *attribs) {
+  if (format == NULL || !format->srgb)
+    return 0;
+
+  if (!wm->egl_ctx->has_gl_colorspace) {
+    LOG_WARNING("EGL_KHR_gl_colorspace unavailable, creating a linear surface.");
+    return 0;
+  }
+
+  attribs[0] = EGL_GL_COLORSPACE_KHR;
+  attribs[1] = EGL_GL_COLORSPACE_SRGB_KHR;
+  return 2;
+}
+
+EGLSurface glps_egl_create_surface(glps_WindowManager *wm, EGLConfig config,
+                                   const glps_SurfaceConfig *format, EGLNativeWindowType native) {
+  EGLint attribs[3];
+  attribs[__surface_attribs(wm, format, attribs)] = EGL_NONE;
+
+  return eglCreateWindowSurface(wm->egl_ctx->dpy, config, native, attribs);
+}
+
+EGLSurface glps_egl_create_pbuffer(glps_WindowManager *wm, EGLConfig config,
+                                   const glps_SurfaceConfig *format, int width, int height) {
+  EGLint attribs[7] = {EGL_WIDTH, width, EGL_HEIGHT, height};
+  attribs[4 + __surface_attribs(wm, format, &attribs[4])] = EGL_NONE;
+
+  return eglCreatePbufferSurface(wm->egl_ctx->dpy, config, attribs);
+}
+
+bool glps_egl_init(glps_WindowManager *wm, EGLNativeDisplayType display) {
+  EGLDisplay dpy = eglGetDisplay((EGLNativeDisplayType)display);
+  if (dpy == EGL_NO_DISPLAY) {
+    LOG_ERROR("Failed to get EGL display");
+    return false;
+  }
+
+  return glps_egl_init_display(wm, dpy, EGL_WINDOW_BIT);
+}
+
+bool glps_egl_init_display(glps_WindowManager *wm, EGLDisplay dpy, EGLint surface_type) {
   wm->egl_ctx = calloc(1, sizeof(glps_EGLContext));
+  if (wm->egl_ctx == NULL) {
+    LOG_ERROR("Failed to allocate EGL context");
+    return false;
+  }
+
+  EGLint major, minor;
 
-  EGLint config_attribs[] = {EGL_SURFACE_TYPE,
-                             EGL_WINDOW_BIT,
-                             EGL_RED_SIZE,
-                             8,
-                             EGL_GREEN_SIZE,
-                             8,
-                             EGL_BLUE_SIZE,
-                             8,
-                             EGL_ALPHA_SIZE,
-                             8,
-                             EGL_RENDERABLE_TYPE,
-                            EGL_OPENGL_ES3_BIT,
-                            EGL_NONE};
-
-  EGLint major, minor, n;
-
-  wm->egl_ctx->dpy =
-      eglGetDisplay((EGLNativeDisplayType)display);
-  assert(wm->egl_ctx->dpy);
+  wm->egl_ctx->dpy = dpy;
+  wm->egl_ctx->surface_type = surface_type;
 
   if (!eglInitialize(wm->egl_ctx->dpy, &major, &minor)) {
     LOG_ERROR("Failed to initialize EGL");
-    exit(EXIT_FAILURE);
+    free(wm->egl_ctx);
+    wm->egl_ctx = NULL;
+    return false;
   }
-  eglSwapInterval(wm->egl_ctx->dpy, 1); 
+  __load_extensions(wm->egl_ctx);
 
-  if (!eglChooseConfig(wm->egl_ctx->dpy, config_attribs, &wm->egl_ctx->conf, 1,
-                       &n) ||
-      n != 1) {
+  // Default format until a window asks for another one.
+  wm->egl_ctx->conf = glps_egl_choose_config(wm, NULL);
+  if (wm->egl_ctx->conf == EGL_NO_CONFIG_KHR) {
     LOG_ERROR("Failed to choose a valid EGL config");
-    exit(EXIT_FAILURE);
+    glps_egl_destroy(wm);
+    return false;
   }
 
   if (!eglBindAPI(EGL_OPENGL_ES_API)) {
     LOG_ERROR("Failed to bind OpenGL ES API");
-    exit(EXIT_FAILURE);
+    glps_egl_destroy(wm);
+    return false;
   }
   EGLint error = eglGetError();
   if (error != EGL_SUCCESS) {
     LOG_ERROR("EGL error: %x", error);
   }
   LOG_INFO("EGL initialized successfully (version %d.%d)", major, minor);
-
+  return true;
 }
 
 
@@ -60,7 +239,10 @@ void glps_egl_create_ctx(glps_WindowManager *wm) {
     EGL_NONE
 };
 
-  wm->egl_ctx->ctx = eglCreateContext(wm->egl_ctx->dpy, wm->egl_ctx->conf,
+  // A config-less context can be made current with surfaces of any format.
+  EGLConfig config = wm->egl_ctx->has_no_config_context ? EGL_NO_CONFIG_KHR : wm->egl_ctx->conf;
+
+  wm->egl_ctx->ctx = eglCreateContext(wm->egl_ctx->dpy, config,
                                       EGL_NO_CONTEXT, context_attribs);
   if (wm->egl_ctx->ctx == EGL_NO_CONTEXT) {
     EGLint error = eglGetError();
@@ -70,8 +252,17 @@ void glps_egl_create_ctx(glps_WindowManager *wm) {
 }
 
 void glps_egl_make_ctx_current(glps_WindowManager *wm, size_t window_id) {
-  if (!eglMakeCurrent(wm->egl_ctx->dpy, wm->windows[window_id]->egl_surface,
-                      wm->windows[window_id]->egl_surface, wm->egl_ctx->ctx)) {
+  EGLSurface surface = wm->windows[GLPS_WINDOW_SLOT(window_id)]->egl_surface;
+  glps_FrameStats *stats = &wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule.stats;
+
+  if (__current.dpy == wm->egl_ctx->dpy && __current.surface == surface &&
+      __current.ctx == wm->egl_ctx->ctx) {
+    stats->context_switches_skipped++;
+    glps_egl_apply_present_mode(wm, window_id);
+    return;
+  }
+
+  if (!eglMakeCurrent(wm->egl_ctx->dpy, surface, surface, wm->egl_ctx->ctx)) {
     EGLint error = eglGetError();
     LOG_ERROR("eglMakeCurrent failed: 0x%x", error);
     if (error == EGL_BAD_DISPLAY)
@@ -84,6 +275,99 @@ void glps_egl_make_ctx_current(glps_WindowManager *wm, size_t window_id) {
       LOG_ERROR("Context or surface attributes mismatch");
     exit(EXIT_FAILURE);
   }
+  __current.dpy = wm->egl_ctx->dpy;
+  __current.surface = surface;
+  __current.ctx = wm->egl_ctx->ctx;
+  __current.window_id = window_id;
+  stats->context_switches++;
+
+  glps_egl_apply_present_mode(wm, window_id);
+}
+
+void glps_egl_release_surface(glps_WindowManager *wm, EGLSurface surface) {
+  if (wm->egl_ctx == NULL || surface == EGL_NO_SURFACE)
+    return;
+
+  // A destroyed surface stays alive while current, and a new surface may
+  // reuse its handle, so it must leave both EGL and the cache.
+  if (eglGetCurrentSurface(EGL_DRAW) == surface || __current.surface == surface) {
+    eglMakeCurrent(wm->egl_ctx->dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    __current.dpy = EGL_NO_DISPLAY;
+    __current.surface = EGL_NO_SURFACE;
+    __current.ctx = EGL_NO_CONTEXT;
+  }
+}
+
+ssize_t glps_egl_current_window(glps_WindowManager *wm) {
+  if (wm->egl_ctx == NULL || __current.dpy != wm->egl_ctx->dpy ||
+      __current.ctx != wm->egl_ctx->ctx || !glps_window_table_is_live(wm, __current.window_id) ||
+      wm->windows[GLPS_WINDOW_SLOT(__current.window_id)]->egl_surface != __current.surface)
+    return -1;
+
+  return (ssize_t)__current.window_id;
+}
+
+// Swap interval limits of the config a surface was created with; windows
+// may use different configs.
+static void __swap_interval_limits(EGLDisplay dpy, EGLSurface surface, EGLint *min, EGLint *max) {
+  EGLint config_id = 0, count = 0;
+  EGLConfig config;
+  *min = 0;
+  *max = 1;
+
+  if (!eglQuerySurface(dpy, surface, EGL_CONFIG_ID, &config_id))
+    return;
+  const EGLint attribs[] = {EGL_CONFIG_ID, config_id, EGL_NONE};
+  if (!eglChooseConfig(dpy, attribs, &config, 1, &count) || count < 1)
+    return;
+
+  if (!eglGetConfigAttrib(dpy, config, EGL_MIN_SWAP_INTERVAL, min) ||
+      !eglGetConfigAttrib(dpy, config, EGL_MAX_SWAP_INTERVAL, max)) {
+    *min = 0;
+    *max = 1;
+  }
+}
+
+void glps_egl_apply_present_mode(glps_WindowManager *wm, size_t window_id) {
+  glps_PresentState *present = &wm->windows[GLPS_WINDOW_SLOT(window_id)]->present;
+  EGLSurface surface = wm->windows[GLPS_WINDOW_SLOT(window_id)]->egl_surface;
+
+  // eglSwapInterval() only reaches the current draw surface; pbuffers are never presented.
+  if (present->applied || surface == EGL_NO_SURFACE || wm->egl_ctx->surface_type != EGL_WINDOW_BIT ||
+      eglGetCurrentSurface(EGL_DRAW) != surface)
+    return;
+
+  EGLint min_interval, max_interval;
+  __swap_interval_limits(wm->egl_ctx->dpy, surface, &min_interval, &max_interval);
+
+  EGLint interval = 0;
+  switch (present->mode) {
+  case GLPS_PRESENT_MODE_ADAPTIVE:
+    // Negative intervals tear late frames where the driver allows them.
+    if (min_interval < 0) {
+      interval = -present->swap_interval;
+      break;
+    }
+    LOG_INFO("Adaptive vsync unavailable, falling back to FIFO.");
+    // fallthrough
+  case GLPS_PRESENT_MODE_FIFO:
+    interval = present->swap_interval;
+    break;
+  case GLPS_PRESENT_MODE_IMMEDIATE:
+  case GLPS_PRESENT_MODE_TEARING:
+    interval = 0;
+    break;
+  }
+
+  if (interval < min_interval || interval > max_interval)
+    LOG_WARNING("Swap interval %d clamped to [%d, %d] by the EGL config.", interval,
+                min_interval, max_interval);
+
+  if (!eglSwapInterval(wm->egl_ctx->dpy, interval))
+    LOG_ERROR("eglSwapInterval(%d) failed: 0x%x", interval, eglGetError());
+
+  // Applied even on failure so a rejected interval is not retried every frame.
+  present->applied = true;
 }
 
 void *glps_egl_get_proc_addr(const char* name) { return eglGetProcAddress; }
@@ -92,6 +376,13 @@ void glps_egl_destroy(glps_WindowManager *wm) {
 
   if (wm == NULL || wm->egl_ctx == NULL) return;
 
+  if (eglGetCurrentContext() == wm->egl_ctx->ctx || __current.ctx == wm->egl_ctx->ctx) {
+    eglMakeCurrent(wm->egl_ctx->dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    __current.dpy = EGL_NO_DISPLAY;
+    __current.surface = EGL_NO_SURFACE;
+    __current.ctx = EGL_NO_CONTEXT;
+  }
+
   if (wm->egl_ctx->ctx) {
     eglDestroyContext(wm->egl_ctx->dpy, wm->egl_ctx->ctx);
     wm->egl_ctx->ctx = EGL_NO_CONTEXT;
@@ -105,8 +396,43 @@ void glps_egl_destroy(glps_WindowManager *wm) {
 }
 
 void glps_egl_swap_buffers(glps_WindowManager *wm, size_t window_id) {
-    if (!eglSwapBuffers(wm->egl_ctx->dpy, wm->windows[window_id]->egl_surface)) {
+    if (!eglSwapBuffers(wm->egl_ctx->dpy, wm->windows[GLPS_WINDOW_SLOT(window_id)]->egl_surface)) {
         LOG_ERROR("eglSwapBuffers failed: 0x%x", eglGetError());
     }
 }
 
+void glps_egl_swap_buffers_with_damage(glps_WindowManager *wm, size_t window_id,
+                                       const glps_Rect *rects, size_t count) {
+  EGLSurface surface = wm->windows[GLPS_WINDOW_SLOT(window_id)]->egl_surface;
+  EGLint height = 0;
+
+  if (wm->egl_ctx->swap_buffers_with_damage == NULL || rects == NULL || count == 0 ||
+      count > MAX_DAMAGE_RECTS || !eglQuerySurface(wm->egl_ctx->dpy, surface, EGL_HEIGHT, &height)) {
+    glps_egl_swap_buffers(wm, window_id);
+    return;
+  }
+
+  // EGL damage has its origin at the bottom left.
+  EGLint damage[MAX_DAMAGE_RECTS * 4];
+  for (size_t i = 0; i < count; ++i) {
+    damage[i * 4 + 0] = rects[i].x;
+    damage[i * 4 + 1] = height - rects[i].y - rects[i].height;
+    damage[i * 4 + 2] = rects[i].width;
+    damage[i * 4 + 3] = rects[i].height;
+  }
+
+  if (!wm->egl_ctx->swap_buffers_with_damage(wm->egl_ctx->dpy, surface, damage, (EGLint)count)) {
+    LOG_ERROR("eglSwapBuffersWithDamage failed: 0x%x", eglGetError());
+  }
+}
+
+int glps_egl_get_buffer_age(glps_WindowManager *wm, size_t window_id) {
+  EGLint age = 0;
+
+  if (!wm->egl_ctx->has_buffer_age ||
+      !eglQuerySurface(wm->egl_ctx->dpy, wm->windows[GLPS_WINDOW_SLOT(window_id)]->egl_surface,
+                       EGL_BUFFER_AGE_EXT, &age))
+    return 0;
+
+  return age;
+}
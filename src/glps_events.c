@@ -0,0 +1,361 @@
+#include "glps_events.h"
+#include "utils/logger/pico_logger.h"
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+#include "glps_input_thread.h"
+#include "glps_latency.h"
+#include "glps_scheduler.h"
+#include "glps_window_table.h"
+#endif
+
+// Window queue threads dispatch next to the main thread, so the timestamp
+// a callback reads is the one of the event dispatched on its own thread.
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+static _Thread_local uint64_t __current_timestamp_ns = 0;
+#else
+static uint64_t __current_timestamp_ns = 0;
+#endif
+
+// Window queue threads emit into the same event queue as the main thread.
+static void __lock(glps_WindowManager *wm)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+    glps_thread_mutex_lock(&wm->shared_lock);
+#else
+    (void)wm;
+#endif
+}
+
+static void __unlock(glps_WindowManager *wm)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+    glps_thread_mutex_unlock(&wm->shared_lock);
+#else
+    (void)wm;
+#endif
+}
+
+static void __queue_push(glps_WindowManager *wm, const glps_Event *event)
+{
+    glps_EventQueue *queue = &wm->event_queue;
+
+    __lock(wm);
+    if (queue->capacity == 0)
+    {
+        __unlock(wm);
+        return;
+    }
+
+    if (queue->tail - queue->head == queue->capacity)
+        wm->event_stats.queue_overflows++;
+    else
+        queue->events[queue->tail++ & (queue->capacity - 1)] = *event;
+    __unlock(wm);
+}
+
+uint64_t glps_events_current_timestamp(void)
+{
+    return __current_timestamp_ns;
+}
+
+bool glps_events_queue_init(glps_WindowManager *wm, size_t capacity)
+{
+    if (wm == NULL) return false;
+
+    glps_events_queue_destroy(wm);
+    if (capacity == 0) return true;
+
+    size_t rounded = 1;
+    while (rounded < capacity)
+    {
+        if (rounded > SIZE_MAX / 2 / sizeof(glps_Event))
+        {
+            LOG_ERROR("Event queue capacity %zu is too large", capacity);
+            return false;
+        }
+        rounded *= 2;
+    }
+
+    glps_Event *events = (glps_Event *)calloc(rounded, sizeof(glps_Event));
+    if (events == NULL)
+    {
+        LOG_ERROR("Failed to allocate event queue");
+        return false;
+    }
+
+    __lock(wm);
+    wm->event_queue = (glps_EventQueue){.events = events, .capacity = rounded};
+    __unlock(wm);
+    return true;
+}
+
+void glps_events_queue_destroy(glps_WindowManager *wm)
+{
+    if (wm == NULL) return;
+
+    __lock(wm);
+    glps_Event *events = wm->event_queue.events;
+    wm->event_queue = (glps_EventQueue){0};
+    __unlock(wm);
+    free(events);
+}
+
+size_t glps_events_queue_pop(glps_WindowManager *wm, glps_Event *out, size_t max)
+{
+    if (wm == NULL || out == NULL) return 0;
+
+    glps_EventQueue *queue = &wm->event_queue;
+    size_t count = 0;
+
+    __lock(wm);
+    while (count < max && queue->head != queue->tail)
+    {
+        out[count++] = queue->events[queue->head & (queue->capacity - 1)];
+        queue->head++;
+    }
+    __unlock(wm);
+
+    return count;
+}
+
+unsigned int glps_events_interest(glps_WindowManager *wm)
+{
+    if (wm == NULL) return 0;
+    if (wm->event_queue.capacity > 0) return GLPS_EVENT_INTEREST_ALL;
+
+    glps_Callback *cb = &wm->callbacks;
+    unsigned int interest = 0;
+
+    if (cb->mouse_move_callback || cb->mouse_enter_callback || cb->mouse_leave_callback)
+        interest |= GLPS_EVENT_INTEREST_POINTER_MOTION;
+    if (cb->mouse_click_callback || cb->mouse_scroll_callback)
+        interest |= GLPS_EVENT_INTEREST_POINTER_BUTTON;
+    if (cb->keyboard_callback || cb->keyboard_enter_callback || cb->keyboard_leave_callback)
+        interest |= GLPS_EVENT_INTEREST_KEYBOARD;
+    if (cb->touch_callback)
+        interest |= GLPS_EVENT_INTEREST_TOUCH;
+
+    return interest;
+}
+
+void glps_events_dispatch(glps_WindowManager *wm, const glps_Event *event)
+{
+    glps_Callback *cb = &wm->callbacks;
+    size_t window_id = event->window_id;
+
+    __current_timestamp_ns = event->timestamp_ns;
+
+    switch (event->type)
+    {
+    case GLPS_EVENT_KEYBOARD_ENTER:
+        if (cb->keyboard_enter_callback)
+            cb->keyboard_enter_callback(window_id, cb->keyboard_enter_data);
+        break;
+
+    case GLPS_EVENT_KEYBOARD_LEAVE:
+        if (cb->keyboard_leave_callback)
+            cb->keyboard_leave_callback(window_id, cb->keyboard_leave_data);
+        break;
+
+    case GLPS_EVENT_KEY:
+        if (cb->keyboard_callback)
+            cb->keyboard_callback(window_id, event->key.state, event->key.text,
+                                  event->key.keycode, cb->keyboard_data);
+        break;
+
+    case GLPS_EVENT_MOUSE_ENTER:
+        if (cb->mouse_enter_callback)
+            cb->mouse_enter_callback(window_id, event->mouse.x, event->mouse.y,
+                                     cb->mouse_enter_data);
+        break;
+
+    case GLPS_EVENT_MOUSE_LEAVE:
+        if (cb->mouse_leave_callback)
+            cb->mouse_leave_callback(window_id, cb->mouse_leave_data);
+        break;
+
+    case GLPS_EVENT_MOUSE_MOVE:
+        if (cb->mouse_move_callback)
+            cb->mouse_move_callback(window_id, event->mouse.x, event->mouse.y,
+                                    cb->mouse_move_data);
+        break;
+
+    case GLPS_EVENT_MOUSE_CLICK:
+        if (cb->mouse_click_callback)
+            cb->mouse_click_callback(window_id, event->click.state, cb->mouse_click_data);
+        break;
+
+    case GLPS_EVENT_MOUSE_SCROLL:
+        if (cb->mouse_scroll_callback)
+            cb->mouse_scroll_callback(window_id, event->scroll.axis, event->scroll.source,
+                                      event->scroll.value, event->scroll.discrete,
+                                      event->scroll.is_stopped, cb->mouse_scroll_data);
+        break;
+
+    case GLPS_EVENT_TOUCH:
+        if (cb->touch_callback)
+            cb->touch_callback(window_id, event->touch.id, event->touch.x, event->touch.y,
+                               event->touch.state, event->touch.major, event->touch.minor,
+                               event->touch.orientation, cb->touch_data);
+        break;
+
+    case GLPS_EVENT_WINDOW_RESIZE:
+        if (cb->window_resize_callback)
+            cb->window_resize_callback(window_id, event->resize.width, event->resize.height,
+                                       cb->window_resize_data);
+        break;
+
+    case GLPS_EVENT_WINDOW_CLOSE:
+        if (cb->window_close_callback)
+            cb->window_close_callback(window_id, cb->window_close_data);
+        break;
+
+    case GLPS_EVENT_WINDOW_VISIBILITY:
+        if (cb->window_visibility_callback)
+            cb->window_visibility_callback(window_id, event->visibility.state,
+                                           cb->window_visibility_data);
+        break;
+
+    case GLPS_EVENT_NONE:
+        break;
+    }
+}
+
+// Returns false if the event was handed to the render thread instead.
+static bool __prepare(glps_WindowManager *wm, glps_Event *event)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+    if (event->timestamp_ns == 0)
+        event->timestamp_ns = glps_latency_now_ns();
+
+    // Listeners running on the input thread hand events to the render thread,
+    // which emits them again from its own side of the ring.
+    if (glps_input_thread_is_current(wm))
+    {
+        glps_input_thread_push(wm, event, event->type == GLPS_EVENT_MOUSE_MOVE);
+        return false;
+    }
+
+    glps_latency_mark_input(wm, event);
+
+    if (event->type != GLPS_EVENT_WINDOW_CLOSE && glps_window_table_is_live(wm, event->window_id))
+        glps_scheduler_request_redraw(&wm->windows[GLPS_WINDOW_SLOT(event->window_id)]->schedule);
+#endif
+
+    __queue_push(wm, event);
+    return true;
+}
+
+void glps_events_dispatch_present(glps_WindowManager *wm, size_t window_id,
+                                  const glps_PresentFeedback *feedback)
+{
+    if (wm->callbacks.window_present_callback)
+        wm->callbacks.window_present_callback(window_id, feedback,
+                                              wm->callbacks.window_present_data);
+}
+
+void glps_events_dispatch_frame(glps_WindowManager *wm, size_t window_id)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+    if (glps_window_table_is_live(wm, window_id))
+        glps_scheduler_frame_done(&wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule,
+                                  glps_latency_now_ns());
+#endif
+
+    if (wm->callbacks.window_frame_update_callback)
+        wm->callbacks.window_frame_update_callback(window_id, wm->callbacks.window_frame_update_data);
+}
+
+void glps_events_emit_visibility(glps_WindowManager *wm, size_t window_id,
+                                 GLPS_VISIBILITY visibility, uint64_t timestamp_ns)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+    if (!glps_window_table_is_live(wm, window_id) ||
+        !glps_scheduler_set_visibility(&wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule, visibility))
+        return;
+
+    glps_events_emit(wm, &(glps_Event){
+                             .type = GLPS_EVENT_WINDOW_VISIBILITY,
+                             .window_id = window_id,
+                             .timestamp_ns = timestamp_ns,
+                             .visibility = {visibility},
+                         });
+#else
+    (void)wm;
+    (void)window_id;
+    (void)visibility;
+    (void)timestamp_ns;
+#endif
+}
+
+bool glps_events_queue_resize(glps_WindowManager *wm, size_t window_id,
+                              glps_ResizeState *resize, int width, int height)
+{
+    resize->pending_width = width;
+    resize->pending_height = height;
+    resize->pending = width != resize->width || height != resize->height;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+    if (resize->pending && glps_window_table_is_live(wm, window_id))
+        glps_scheduler_request_redraw(&wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule);
+#else
+    (void)wm;
+    (void)window_id;
+#endif
+
+    return resize->pending;
+}
+
+bool glps_events_flush_resize(glps_WindowManager *wm, size_t window_id, glps_ResizeState *resize)
+{
+    if (!resize->pending) return false;
+
+    resize->pending = false;
+    resize->width = resize->pending_width;
+    resize->height = resize->pending_height;
+
+    glps_events_emit(wm, &(glps_Event){
+                             .type = GLPS_EVENT_WINDOW_RESIZE,
+                             .window_id = window_id,
+                             .resize = {resize->width, resize->height},
+                         });
+    return true;
+}
+
+void glps_events_emit(glps_WindowManager *wm, const glps_Event *event)
+{
+    if (wm == NULL || event == NULL) return;
+
+    glps_Event stamped = *event;
+    if (__prepare(wm, &stamped))
+        glps_events_dispatch(wm, &stamped);
+}
+
+void glps_events_emit_key(glps_WindowManager *wm, size_t window_id, bool state,
+                          const char *text, unsigned long keycode, uint64_t timestamp_ns)
+{
+    if (wm == NULL) return;
+
+    glps_Event event = {
+        .type = GLPS_EVENT_KEY,
+        .window_id = window_id,
+        .timestamp_ns = timestamp_ns,
+        .key = {.state = state, .keycode = keycode},
+    };
+    if (text != NULL && snprintf(event.key.text, sizeof(event.key.text), "%s", text) >=
+                            (int)sizeof(event.key.text))
+    {
+        // Don't leave half a UTF-8 sequence at the end of truncated text.
+        size_t len = sizeof(event.key.text) - 1;
+        while (len > 0 && ((unsigned char)event.key.text[len - 1] & 0xC0) == 0x80) len--;
+        if (len > 0 && ((unsigned char)event.key.text[len - 1] & 0x80)) len--;
+        event.key.text[len] = '\0';
+    }
+
+    if (!__prepare(wm, &event)) return;
+
+    __current_timestamp_ns = event.timestamp_ns;
+    if (wm->callbacks.keyboard_callback)
+        wm->callbacks.keyboard_callback(window_id, state, text != NULL ? text : "",
+                                        keycode, wm->callbacks.keyboard_data);
+}
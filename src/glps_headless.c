@@ -0,0 +1,210 @@
+#include "glps_headless.h"
+#include "glps_capture.h"
+#include "glps_egl_context.h"
+#include "glps_events.h"
+#include "glps_latency.h"
+#include "glps_scheduler.h"
+#include "glps_wakeup.h"
+#include "glps_window_table.h"
+#include "utils/logger/pico_logger.h"
+
+#include <poll.h>
+
+#define MAX_EGL_DEVICES 8
+
+#ifdef GLPS_USE_WAYLAND
+typedef glps_WaylandWindow glps_HeadlessWindow;
+#else
+typedef glps_X11Window glps_HeadlessWindow;
+#endif
+
+static bool __init_platform(glps_WindowManager *wm, PFNEGLGETPLATFORMDISPLAYEXTPROC get_display,
+                            EGLenum platform, void *native)
+{
+    EGLDisplay dpy = get_display(platform, native, NULL);
+    return dpy != EGL_NO_DISPLAY && glps_egl_init_display(wm, dpy, EGL_PBUFFER_BIT);
+}
+
+static bool __init_egl(glps_WindowManager *wm)
+{
+    const char *client = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (client == NULL || get_display == NULL)
+    {
+        LOG_ERROR("EGL client extensions unavailable, cannot open a headless display.");
+        return false;
+    }
+
+    if (glps_egl_has_extension(client, "EGL_MESA_platform_surfaceless") &&
+        __init_platform(wm, get_display, EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY))
+    {
+        LOG_INFO("Headless rendering on EGL_MESA_platform_surfaceless.");
+        return true;
+    }
+
+    PFNEGLQUERYDEVICESEXTPROC query_devices =
+        (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+    EGLDeviceEXT devices[MAX_EGL_DEVICES];
+    EGLint count = 0;
+    if (glps_egl_has_extension(client, "EGL_EXT_platform_device") && query_devices != NULL &&
+        query_devices(MAX_EGL_DEVICES, devices, &count))
+    {
+        for (EGLint i = 0; i < count; ++i)
+        {
+            if (__init_platform(wm, get_display, EGL_PLATFORM_DEVICE_EXT, devices[i]))
+            {
+                LOG_INFO("Headless rendering on EGL device %d.", (int)i);
+                return true;
+            }
+        }
+    }
+
+    LOG_ERROR("No surfaceless platform or EGL device available.");
+    return false;
+}
+
+bool glps_headless_init(glps_WindowManager *wm)
+{
+    if (wm == NULL) return false;
+
+    if (!glps_window_table_init(wm))
+    {
+        LOG_ERROR("Failed to allocate windows array");
+        return false;
+    }
+
+    if (!__init_egl(wm))
+    {
+        glps_window_table_destroy(wm);
+        return false;
+    }
+
+    wm->headless = true;
+    return true;
+}
+
+ssize_t glps_headless_window_create(glps_WindowManager *wm, const char *title,
+                                    int width, int height, const glps_SurfaceConfig *config)
+{
+    if (wm == NULL || wm->egl_ctx == NULL || title == NULL || width <= 0 || height <= 0)
+    {
+        LOG_ERROR("glps_headless_window_create: invalid arguments");
+        return -1;
+    }
+
+    EGLConfig egl_config = glps_egl_choose_config(wm, config);
+    if (egl_config == EGL_NO_CONFIG_KHR) return -1;
+
+    glps_HeadlessWindow *window = calloc(1, sizeof(glps_HeadlessWindow));
+    if (window == NULL)
+    {
+        LOG_ERROR("Failed to allocate window");
+        return -1;
+    }
+
+    window->egl_surface = glps_egl_create_pbuffer(wm, egl_config, config, width, height);
+    if (window->egl_surface == EGL_NO_SURFACE)
+    {
+        LOG_ERROR("Failed to create pbuffer (eglGetError: 0x%x)", eglGetError());
+        free(window);
+        return -1;
+    }
+
+    glps_scheduler_init(&window->schedule);
+    // Nothing to pace against: frames run as fast as the CPU allows.
+    glps_scheduler_set_target(&window->schedule, GLPS_FPS_UNCAPPED);
+    window->present = (glps_PresentState){.mode = GLPS_PRESENT_MODE_IMMEDIATE, .swap_interval = 1};
+    window->resize = (glps_ResizeState){.width = width, .height = height};
+#ifdef GLPS_USE_WAYLAND
+    window->properties.width = width;
+    window->properties.height = height;
+    strncpy(window->properties.title, title, sizeof(window->properties.title) - 1);
+#else
+    window->monitor = -1;
+    window->colormap = None;
+#endif
+
+    ssize_t window_id = glps_window_table_insert(wm, window);
+    if (window_id < 0)
+    {
+        LOG_ERROR("Failed to register headless window");
+        eglDestroySurface(wm->egl_ctx->dpy, window->egl_surface);
+        free(window);
+        return -1;
+    }
+
+    if (wm->egl_ctx->ctx == EGL_NO_CONTEXT) glps_egl_create_ctx(wm);
+    glps_egl_make_ctx_current(wm, (size_t)window_id);
+
+    return window_id;
+}
+
+void glps_headless_window_update(glps_WindowManager *wm, size_t window_id)
+{
+    if (wm == NULL || !glps_window_table_is_live(wm, window_id)) return;
+
+    glps_FrameSchedule *schedule = &wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule;
+    if (glps_scheduler_interval_ns(schedule) != 0) glps_scheduler_wait(schedule);
+
+    glps_events_dispatch_frame(wm, window_id);
+}
+
+void glps_headless_window_destroy(glps_WindowManager *wm, size_t window_id)
+{
+    glps_HeadlessWindow *window = glps_window_table_get(wm, window_id);
+    if (window == NULL) return;
+
+    glps_capture_stop(wm, window_id, NULL);
+
+    if (wm->egl_ctx != NULL)
+    {
+        glps_egl_release_surface(wm, window->egl_surface);
+        eglDestroySurface(wm->egl_ctx->dpy, window->egl_surface);
+    }
+
+    glps_window_table_remove(wm, window_id);
+    free(window);
+}
+
+bool glps_headless_should_close(glps_WindowManager *wm)
+{
+    if (wm == NULL) return true;
+
+    glps_wakeup_drain(wm);
+    return wm->should_close || wm->window_count == 0;
+}
+
+bool glps_headless_wait_events(glps_WindowManager *wm, int64_t timeout_ns)
+{
+    if (wm == NULL) return true;
+
+    // Only a wakeup or a timer can end the wait; without the eventfd that
+    // leaves the timeout, and an endless wait would never return.
+    if (wm->wakeup_fd >= 0)
+    {
+        struct pollfd fd = {.fd = wm->wakeup_fd, .events = POLLIN};
+        if (poll(&fd, 1, glps_wakeup_timeout_ms(timeout_ns)) < 0 && errno != EINTR)
+            LOG_ERROR("poll on wakeup eventfd failed: %s", strerror(errno));
+    }
+    else if (timeout_ns > 0)
+    {
+        glps_scheduler_sleep_until(glps_latency_now_ns() + (uint64_t)timeout_ns);
+    }
+
+    return glps_headless_should_close(wm);
+}
+
+void glps_headless_destroy(glps_WindowManager *wm)
+{
+    if (wm == NULL) return;
+
+    for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
+    {
+        ssize_t window_id = glps_window_table_id_at(wm, slot);
+        if (window_id >= 0) glps_headless_window_destroy(wm, (size_t)window_id);
+    }
+    glps_window_table_destroy(wm);
+    glps_egl_destroy(wm);
+    wm->headless = false;
+}
@@ -0,0 +1,195 @@
+#include "glps_input_thread.h"
+#include "glps_wakeup.h"
+#include "utils/logger/pico_logger.h"
+
+#include <time.h>
+
+#ifdef GLPS_USE_WAYLAND
+#include "glps_wayland.h"
+#endif
+
+#ifdef GLPS_USE_X11
+#include "glps_x11.h"
+#endif
+
+// Pause between checks while an event that cannot be dropped waits for room.
+#define FULL_RING_PAUSE_NS 100000
+
+static _Thread_local glps_WindowManager *__current_wm = NULL;
+
+// Slots only events that must not be dropped may fill, so a burst of motion
+// cannot crowd out a close or a resize.
+static size_t __reserved_slots(const glps_SpscRing *ring)
+{
+    return ring->capacity / 4;
+}
+
+void glps_input_thread_enter(glps_WindowManager *wm)
+{
+    __current_wm = wm;
+}
+
+bool glps_input_thread_start(glps_WindowManager *wm, size_t capacity)
+{
+    if (wm == NULL) return false;
+
+    if (wm->input_thread != NULL)
+    {
+        LOG_WARNING("Input thread is already running.");
+        return true;
+    }
+
+    if (wm->wakeup_fd < 0)
+    {
+        LOG_ERROR("Input thread needs the wakeup eventfd to signal the render thread.");
+        return false;
+    }
+
+    struct glps_InputThread *input = (struct glps_InputThread *)calloc(1, sizeof(*input));
+    if (input == NULL)
+    {
+        LOG_ERROR("Failed to allocate input thread");
+        return false;
+    }
+    input->wm = wm;
+    atomic_init(&input->running, true);
+    atomic_init(&input->overflows, 0);
+
+#ifdef GLPS_USE_WAYLAND
+    size_t element_size = sizeof(glps_Event);
+#else
+    size_t element_size = sizeof(XEvent);
+#endif
+
+    if (!glps_spsc_init(&input->ring, element_size, capacity))
+    {
+        free(input);
+        return false;
+    }
+
+    glps_thread_mutex_init(&input->lock, NULL);
+    wm->input_thread = input;
+
+#ifdef GLPS_USE_WAYLAND
+    bool ready = glps_wl_input_thread_setup(wm);
+#else
+    bool ready = glps_x11_input_thread_setup(wm);
+#endif
+
+    if (ready)
+    {
+#ifdef GLPS_USE_WAYLAND
+        ready = glps_thread_create(&input->thread, NULL, glps_wl_input_thread_run, wm) == 0;
+        if (!ready) glps_wl_input_thread_teardown(wm);
+#else
+        ready = glps_thread_create(&input->thread, NULL, glps_x11_input_thread_run, wm) == 0;
+        if (!ready) glps_x11_input_thread_teardown(wm);
+#endif
+    }
+
+    if (!ready)
+    {
+        LOG_ERROR("Failed to start input thread");
+        wm->input_thread = NULL;
+        glps_thread_mutex_destroy(&input->lock);
+        glps_spsc_destroy(&input->ring);
+        free(input);
+        return false;
+    }
+
+    return true;
+}
+
+void glps_input_thread_stop(glps_WindowManager *wm)
+{
+    if (wm == NULL || wm->input_thread == NULL) return;
+
+    struct glps_InputThread *input = wm->input_thread;
+
+    atomic_store(&input->running, false);
+#ifdef GLPS_USE_WAYLAND
+    glps_wl_input_thread_wake(wm);
+#else
+    glps_x11_input_thread_wake(wm);
+#endif
+    glps_thread_join(input->thread, NULL);
+
+    // Teardown hands whatever is still buffered back to the render thread.
+#ifdef GLPS_USE_WAYLAND
+    glps_wl_input_thread_teardown(wm);
+#else
+    glps_x11_input_thread_teardown(wm);
+#endif
+
+    wm->input_thread = NULL;
+    wm->event_stats.input_overflows += atomic_load(&input->overflows);
+    glps_thread_mutex_destroy(&input->lock);
+    glps_spsc_destroy(&input->ring);
+    free(input);
+}
+
+bool glps_input_thread_is_current(glps_WindowManager *wm)
+{
+    return wm != NULL && __current_wm == wm;
+}
+
+bool glps_input_thread_push(glps_WindowManager *wm, const void *element, bool droppable)
+{
+    struct glps_InputThread *input = wm->input_thread;
+
+    if (droppable)
+    {
+        if (glps_spsc_size(&input->ring) + __reserved_slots(&input->ring) >= input->ring.capacity ||
+            !glps_spsc_push(&input->ring, element))
+        {
+            atomic_fetch_add_explicit(&input->overflows, 1, memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // Wait for the render thread to make room rather than lose the event.
+    while (!glps_spsc_push(&input->ring, element))
+    {
+        if (!atomic_load(&input->running)) return false;
+
+        glps_wakeup_post(wm);
+        struct timespec pause = {.tv_sec = 0, .tv_nsec = FULL_RING_PAUSE_NS};
+        nanosleep(&pause, NULL);
+    }
+
+    return true;
+}
+
+bool glps_input_thread_pop(glps_WindowManager *wm, void *element)
+{
+    if (wm == NULL || wm->input_thread == NULL) return false;
+
+    return glps_spsc_pop(&wm->input_thread->ring, element);
+}
+
+uint64_t glps_input_thread_overflows(glps_WindowManager *wm)
+{
+    if (wm == NULL || wm->input_thread == NULL) return 0;
+
+    return atomic_load_explicit(&wm->input_thread->overflows, memory_order_relaxed);
+}
+
+size_t glps_input_thread_pending(glps_WindowManager *wm)
+{
+    if (wm == NULL || wm->input_thread == NULL) return 0;
+
+    return glps_spsc_size(&wm->input_thread->ring);
+}
+
+void glps_input_thread_lock(glps_WindowManager *wm)
+{
+    if (wm != NULL && wm->input_thread != NULL)
+        glps_thread_mutex_lock(&wm->input_thread->lock);
+}
+
+void glps_input_thread_unlock(glps_WindowManager *wm)
+{
+    if (wm != NULL && wm->input_thread != NULL)
+        glps_thread_mutex_unlock(&wm->input_thread->lock);
+}
@@ -0,0 +1,80 @@
+#include "glps_latency.h"
+#include "glps_window_table.h"
+
+static glps_LatencyProbe *__get_probe(glps_WindowManager *wm, size_t window_id)
+{
+    if (!glps_window_table_is_live(wm, window_id)) return NULL;
+
+    return &wm->windows[GLPS_WINDOW_SLOT(window_id)]->latency;
+}
+
+uint64_t glps_latency_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+uint64_t glps_latency_from_server_ms(glps_WindowManager *wm, uint32_t time_ms)
+{
+    uint64_t now = glps_latency_now_ns();
+    glps_InputClock *clock = &wm->input_clock;
+
+    if (clock->valid && time_ms < clock->last_ms && clock->last_ms - time_ms > 0x80000000u)
+        clock->wraps++;
+    if (!clock->valid || time_ms > clock->last_ms || clock->last_ms - time_ms > 0x80000000u)
+        clock->last_ms = time_ms;
+
+    uint64_t server_ns = ((clock->wraps << 32) + time_ms) * 1000000ull;
+    int64_t offset = (int64_t)(now - server_ns);
+
+    if (!clock->valid || offset < clock->offset_ns)
+    {
+        clock->offset_ns = offset;
+        clock->valid = true;
+    }
+
+    uint64_t timestamp = server_ns + (uint64_t)clock->offset_ns;
+    return timestamp > now ? now : timestamp;
+}
+
+void glps_latency_mark_input(glps_WindowManager *wm, const glps_Event *event)
+{
+    switch (event->type)
+    {
+    case GLPS_EVENT_KEY:
+    case GLPS_EVENT_MOUSE_MOVE:
+    case GLPS_EVENT_MOUSE_CLICK:
+    case GLPS_EVENT_MOUSE_SCROLL:
+    case GLPS_EVENT_TOUCH:
+        break;
+    default:
+        return;
+    }
+
+    glps_LatencyProbe *probe = __get_probe(wm, event->window_id);
+    if (probe == NULL) return;
+
+    if (probe->pending_since_ns == 0 || event->timestamp_ns < probe->pending_since_ns)
+        probe->pending_since_ns = event->timestamp_ns;
+}
+
+void glps_latency_record_swap(glps_WindowManager *wm, size_t window_id)
+{
+    glps_LatencyProbe *probe = __get_probe(wm, window_id);
+    if (probe == NULL || probe->pending_since_ns == 0) return;
+
+    uint64_t now = glps_latency_now_ns();
+    uint64_t latency = now > probe->pending_since_ns ? now - probe->pending_since_ns : 0;
+    probe->pending_since_ns = 0;
+
+    size_t bucket = 0;
+    for (uint64_t us = latency / 1000; us > 1 && bucket < GLPS_LATENCY_BUCKET_COUNT - 1; us >>= 1)
+        bucket++;
+
+    glps_LatencyHistogram *histogram = &probe->histogram;
+    histogram->count++;
+    histogram->total_ns += latency;
+    if (latency > histogram->max_ns) histogram->max_ns = latency;
+    histogram->buckets[bucket]++;
+}
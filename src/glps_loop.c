@@ -0,0 +1,342 @@
+#include "glps_loop.h"
+#include "glps_wakeup.h"
+#include "glps_window_manager.h"
+#include "utils/logger/pico_logger.h"
+#include "utils/uthash/uthash.h"
+
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define GLPS_LOOP_MAX_EVENTS 32
+
+typedef enum {
+    GLPS_LOOP_SOURCE_DISPLAY,
+    GLPS_LOOP_SOURCE_QUIT,
+    GLPS_LOOP_SOURCE_TIMER,
+    GLPS_LOOP_SOURCE_FD,
+} glps_LoopSourceKind;
+
+typedef struct glps_LoopSource {
+    int fd;
+    glps_LoopSourceKind kind;
+    bool removed;
+    timer_callback timer_callback;
+    glps_loop_fd_callback fd_callback;
+    void *arg;
+    struct glps_LoopSource *next_removed;
+    UT_hash_handle hh;
+} glps_LoopSource;
+
+struct glps_loop {
+    glps_WindowManager *wm;
+    int epoll_fd;
+    int quit_fd;
+    atomic_bool quit;
+    glps_LoopSource *sources;  /**< Keyed by fd. */
+    glps_LoopSource *removed;  /**< Freed once the current dispatch is done. */
+};
+
+static uint32_t __to_epoll_events(uint32_t events)
+{
+    uint32_t epoll_events = 0;
+    if (events & GLPS_LOOP_READABLE) epoll_events |= EPOLLIN;
+    if (events & GLPS_LOOP_WRITABLE) epoll_events |= EPOLLOUT;
+    return epoll_events;
+}
+
+static uint32_t __from_epoll_events(uint32_t epoll_events)
+{
+    uint32_t events = 0;
+    if (epoll_events & EPOLLIN) events |= GLPS_LOOP_READABLE;
+    if (epoll_events & EPOLLOUT) events |= GLPS_LOOP_WRITABLE;
+    if (epoll_events & (EPOLLERR | EPOLLHUP)) events |= GLPS_LOOP_HANGUP;
+    return events;
+}
+
+static glps_LoopSource *__add_source(glps_loop *loop, int fd, glps_LoopSourceKind kind, uint32_t epoll_events)
+{
+    glps_LoopSource *source = NULL;
+    HASH_FIND_INT(loop->sources, &fd, source);
+    if (source != NULL)
+    {
+        LOG_ERROR("fd %d is already registered with the loop", fd);
+        return NULL;
+    }
+
+    source = (glps_LoopSource *)calloc(1, sizeof(glps_LoopSource));
+    if (source == NULL)
+    {
+        LOG_ERROR("Failed to allocate loop source");
+        return NULL;
+    }
+    source->fd = fd;
+    source->kind = kind;
+
+    struct epoll_event event = {.events = epoll_events, .data.ptr = source};
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        LOG_ERROR("epoll_ctl(ADD, %d) failed: %s", fd, strerror(errno));
+        free(source);
+        return NULL;
+    }
+
+    HASH_ADD_INT(loop->sources, fd, source);
+    return source;
+}
+
+// epoll may still hand out a pointer to a source removed earlier in the same
+// batch, so sources are unlinked immediately but freed after dispatch.
+static void __remove_source(glps_loop *loop, glps_LoopSource *source)
+{
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, source->fd, NULL);
+    HASH_DEL(loop->sources, source);
+
+    if (source->kind == GLPS_LOOP_SOURCE_TIMER) close(source->fd);
+
+    source->removed = true;
+    source->next_removed = loop->removed;
+    loop->removed = source;
+}
+
+static void __free_removed(glps_loop *loop)
+{
+    while (loop->removed != NULL)
+    {
+        glps_LoopSource *next = loop->removed->next_removed;
+        free(loop->removed);
+        loop->removed = next;
+    }
+}
+
+glps_loop *glps_loop_create(glps_WindowManager *wm)
+{
+    glps_loop *loop = (glps_loop *)calloc(1, sizeof(glps_loop));
+    if (loop == NULL)
+    {
+        LOG_ERROR("Failed to allocate glps_loop");
+        return NULL;
+    }
+    loop->wm = wm;
+    loop->quit_fd = -1;
+    atomic_init(&loop->quit, false);
+
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll_fd < 0)
+    {
+        LOG_ERROR("epoll_create1 failed: %s", strerror(errno));
+        free(loop);
+        return NULL;
+    }
+
+    loop->quit_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (loop->quit_fd < 0 || __add_source(loop, loop->quit_fd, GLPS_LOOP_SOURCE_QUIT, EPOLLIN) == NULL)
+    {
+        LOG_ERROR("Failed to set up loop quit eventfd");
+        glps_loop_destroy(loop);
+        return NULL;
+    }
+
+    if (wm != NULL)
+    {
+        int fds[2];
+        size_t count = glps_wm_get_fds(wm, fds, 2);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (__add_source(loop, fds[i], GLPS_LOOP_SOURCE_DISPLAY, EPOLLIN) == NULL)
+            {
+                glps_loop_destroy(loop);
+                return NULL;
+            }
+        }
+    }
+
+    return loop;
+}
+
+void glps_loop_destroy(glps_loop *loop)
+{
+    if (loop == NULL) return;
+
+    glps_LoopSource *source, *tmp;
+    HASH_ITER(hh, loop->sources, source, tmp)
+    {
+        __remove_source(loop, source);
+    }
+    __free_removed(loop);
+
+    if (loop->quit_fd >= 0) close(loop->quit_fd);
+    if (loop->epoll_fd >= 0) close(loop->epoll_fd);
+    free(loop);
+}
+
+int glps_loop_add_timer(glps_loop *loop, uint64_t interval_ns, bool repeat,
+                        timer_callback callback, void *arg)
+{
+    if (loop == NULL || callback == NULL)
+    {
+        LOG_CRITICAL("Loop and/or Callback function NULL.");
+        return -1;
+    }
+
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (fd < 0)
+    {
+        LOG_ERROR("timerfd_create failed: %s", strerror(errno));
+        return -1;
+    }
+
+    // A zero it_value disarms a timerfd, so round up to the smallest interval.
+    if (interval_ns == 0) interval_ns = 1;
+
+    struct timespec interval = {
+        .tv_sec = (time_t)(interval_ns / 1000000000ull),
+        .tv_nsec = (long)(interval_ns % 1000000000ull),
+    };
+    struct itimerspec spec = {
+        .it_value = interval,
+        .it_interval = repeat ? interval : (struct timespec){0},
+    };
+
+    if (timerfd_settime(fd, 0, &spec, NULL) < 0)
+    {
+        LOG_ERROR("timerfd_settime failed: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    glps_LoopSource *source = __add_source(loop, fd, GLPS_LOOP_SOURCE_TIMER, EPOLLIN);
+    if (source == NULL)
+    {
+        close(fd);
+        return -1;
+    }
+    source->timer_callback = callback;
+    source->arg = arg;
+
+    return fd;
+}
+
+void glps_loop_remove_timer(glps_loop *loop, int timer_id)
+{
+    if (loop == NULL) return;
+
+    glps_LoopSource *source = NULL;
+    HASH_FIND_INT(loop->sources, &timer_id, source);
+    if (source == NULL || source->kind != GLPS_LOOP_SOURCE_TIMER) return;
+
+    __remove_source(loop, source);
+}
+
+bool glps_loop_add_fd(glps_loop *loop, int fd, uint32_t events,
+                      glps_loop_fd_callback callback, void *arg)
+{
+    if (loop == NULL || callback == NULL)
+    {
+        LOG_CRITICAL("Loop and/or Callback function NULL.");
+        return false;
+    }
+
+    glps_LoopSource *source = __add_source(loop, fd, GLPS_LOOP_SOURCE_FD, __to_epoll_events(events));
+    if (source == NULL) return false;
+
+    source->fd_callback = callback;
+    source->arg = arg;
+    return true;
+}
+
+void glps_loop_remove_fd(glps_loop *loop, int fd)
+{
+    if (loop == NULL) return;
+
+    glps_LoopSource *source = NULL;
+    HASH_FIND_INT(loop->sources, &fd, source);
+    if (source == NULL || source->kind != GLPS_LOOP_SOURCE_FD) return;
+
+    __remove_source(loop, source);
+}
+
+bool glps_loop_run_once(glps_loop *loop, int64_t timeout_ns)
+{
+    if (loop == NULL) return true;
+    if (atomic_load(&loop->quit)) return true;
+
+    // glps_wm_prepare() must always be paired with glps_wm_dispatch_pending().
+    if (loop->wm != NULL)
+    {
+        if (!glps_wm_prepare(loop->wm)) timeout_ns = 0;
+
+        // Frames the window manager schedules itself run from dispatch_pending.
+        int64_t frame_timeout_ns = glps_wm_next_timeout_ns(loop->wm);
+        if (frame_timeout_ns >= 0 && (timeout_ns < 0 || frame_timeout_ns < timeout_ns))
+            timeout_ns = frame_timeout_ns;
+    }
+
+    struct epoll_event events[GLPS_LOOP_MAX_EVENTS];
+    int count = epoll_wait(loop->epoll_fd, events, GLPS_LOOP_MAX_EVENTS, glps_wakeup_timeout_ms(timeout_ns));
+    if (count < 0)
+    {
+        if (errno != EINTR) LOG_ERROR("epoll_wait failed: %s", strerror(errno));
+        count = 0;
+    }
+
+    bool should_close = loop->wm != NULL && glps_wm_dispatch_pending(loop->wm);
+
+    for (int i = 0; i < count; ++i)
+    {
+        glps_LoopSource *source = (glps_LoopSource *)events[i].data.ptr;
+        if (source->removed) continue;
+
+        switch (source->kind)
+        {
+        case GLPS_LOOP_SOURCE_DISPLAY:
+            // Handled by glps_wm_dispatch_pending() above.
+            break;
+
+        case GLPS_LOOP_SOURCE_QUIT:
+        {
+            uint64_t value;
+            while (read(source->fd, &value, sizeof(value)) < 0 && errno == EINTR)
+                ;
+            break;
+        }
+
+        case GLPS_LOOP_SOURCE_TIMER:
+        {
+            uint64_t expirations = 0;
+            if (read(source->fd, &expirations, sizeof(expirations)) != sizeof(expirations)) break;
+
+            // Same catch-up behaviour as glps_timer_check_and_call().
+            while (expirations-- > 0 && !source->removed)
+                source->timer_callback(source->arg);
+            break;
+        }
+
+        case GLPS_LOOP_SOURCE_FD:
+            source->fd_callback(source->fd, __from_epoll_events(events[i].events), source->arg);
+            break;
+        }
+    }
+
+    __free_removed(loop);
+
+    return should_close || atomic_load(&loop->quit);
+}
+
+void glps_loop_run(glps_loop *loop)
+{
+    while (!glps_loop_run_once(loop, -1))
+        ;
+}
+
+void glps_loop_quit(glps_loop *loop)
+{
+    if (loop == NULL) return;
+
+    atomic_store(&loop->quit, true);
+
+    uint64_t value = 1;
+    while (write(loop->quit_fd, &value, sizeof(value)) < 0 && errno == EINTR)
+        ;
+}
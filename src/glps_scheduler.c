@@ -0,0 +1,199 @@
+#include "glps_scheduler.h"
+#include "glps_latency.h"
+#include "utils/logger/pico_logger.h"
+
+void glps_scheduler_init(glps_FrameSchedule *schedule)
+{
+    *schedule = (glps_FrameSchedule){.target_fps = GLPS_FPS_DISPLAY};
+}
+
+void glps_scheduler_set_target(glps_FrameSchedule *schedule, double fps)
+{
+    schedule->target_fps = fps < 0.0 ? GLPS_FPS_UNCAPPED : fps;
+    schedule->next_frame_ns = 0;
+    schedule->deferred = false;
+}
+
+bool glps_scheduler_set_refresh(glps_FrameSchedule *schedule, uint64_t refresh_ns)
+{
+    if (refresh_ns == 0) return false;
+
+    // Measured intervals jitter; only a real mode or monitor change counts.
+    uint64_t delta = refresh_ns > schedule->refresh_ns ? refresh_ns - schedule->refresh_ns
+                                                      : schedule->refresh_ns - refresh_ns;
+    if (schedule->refresh_ns != 0 && delta * 100 < schedule->refresh_ns) return false;
+
+    LOG_INFO("Window refresh rate is now %.2f Hz", 1e9 / (double)refresh_ns);
+    schedule->refresh_ns = refresh_ns;
+    schedule->next_frame_ns = 0;
+    return true;
+}
+
+uint64_t glps_scheduler_refresh_ns(const glps_FrameSchedule *schedule)
+{
+    return schedule->refresh_ns != 0 ? schedule->refresh_ns : GLPS_SCHEDULER_DEFAULT_REFRESH_NS;
+}
+
+uint64_t glps_scheduler_interval_ns(const glps_FrameSchedule *schedule)
+{
+    if (schedule->target_fps < 0.0) return 0;
+    if (schedule->target_fps > 0.0) return (uint64_t)(1e9 / schedule->target_fps);
+
+    return glps_scheduler_refresh_ns(schedule);
+}
+
+bool glps_scheduler_is_due(const glps_FrameSchedule *schedule, uint64_t now_ns)
+{
+    return schedule->next_frame_ns <= now_ns + glps_scheduler_refresh_ns(schedule) / 2;
+}
+
+void glps_scheduler_advance(glps_FrameSchedule *schedule, uint64_t now_ns)
+{
+    uint64_t interval = glps_scheduler_interval_ns(schedule);
+
+    schedule->deferred = false;
+    schedule->next_frame_ns = schedule->next_frame_ns + interval > now_ns
+                                  ? schedule->next_frame_ns + interval
+                                  : now_ns + interval;
+}
+
+void glps_scheduler_sleep_until(uint64_t deadline_ns)
+{
+    struct timespec deadline = {
+        .tv_sec = (time_t)(deadline_ns / 1000000000ull),
+        .tv_nsec = (long)(deadline_ns % 1000000000ull),
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+        ;
+}
+
+void glps_scheduler_wait(glps_FrameSchedule *schedule)
+{
+    uint64_t now = glps_latency_now_ns();
+
+    if (schedule->next_frame_ns > now)
+    {
+        glps_scheduler_sleep_until(schedule->next_frame_ns);
+        now = schedule->next_frame_ns;
+    }
+
+    glps_scheduler_advance(schedule, now);
+}
+
+static uint64_t __estimate_render_ns(const glps_FrameSchedule *schedule)
+{
+    size_t count = schedule->render_count < GLPS_RENDER_SAMPLE_COUNT ? schedule->render_count
+                                                                      : GLPS_RENDER_SAMPLE_COUNT;
+    if (count < GLPS_SCHEDULER_MIN_RENDER_SAMPLES) return glps_scheduler_refresh_ns(schedule);
+
+    uint64_t sorted[GLPS_RENDER_SAMPLE_COUNT];
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t j = i;
+        for (; j > 0 && sorted[j - 1] > schedule->render_ns[i]; --j)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = schedule->render_ns[i];
+    }
+
+    return sorted[(count - 1) * GLPS_SCHEDULER_RENDER_PERCENTILE / 100] + GLPS_SCHEDULER_LATCH_MARGIN_NS;
+}
+
+void glps_scheduler_begin_render(glps_FrameSchedule *schedule, uint64_t last_present_ns,
+                                 glps_FrameDeadline *deadline)
+{
+    uint64_t now = glps_latency_now_ns();
+    uint64_t refresh = glps_scheduler_refresh_ns(schedule);
+    uint64_t render = __estimate_render_ns(schedule);
+    uint64_t earliest = now + render;
+
+    // Extrapolating further than a second drifts too far from the real vblanks.
+    bool predicted = last_present_ns != 0 && last_present_ns <= now && now - last_present_ns < 1000000000ull;
+
+    uint64_t present = earliest;
+    if (predicted && earliest > last_present_ns)
+        present = last_present_ns + (earliest - last_present_ns + refresh - 1) / refresh * refresh;
+
+    *deadline = (glps_FrameDeadline){
+        .present_ns = present,
+        .render_start_ns = present - render,
+        .render_ns = render,
+        .refresh_ns = refresh,
+        .predicted = predicted,
+    };
+
+    // Without enough measured frames the estimate is a guess; report it only.
+    if (schedule->render_count >= GLPS_SCHEDULER_MIN_RENDER_SAMPLES && deadline->render_start_ns > now)
+    {
+        glps_scheduler_sleep_until(deadline->render_start_ns);
+        now = deadline->render_start_ns;
+    }
+    schedule->render_begin_ns = now;
+}
+
+void glps_scheduler_end_render(glps_FrameSchedule *schedule)
+{
+    if (schedule->render_begin_ns == 0) return;
+
+    uint64_t now = glps_latency_now_ns();
+    schedule->render_ns[schedule->render_count++ % GLPS_RENDER_SAMPLE_COUNT] =
+        now > schedule->render_begin_ns ? now - schedule->render_begin_ns : 0;
+    schedule->render_begin_ns = 0;
+}
+
+uint64_t glps_scheduler_next_frame_at(const glps_FrameSchedule *schedule, uint64_t now_ns)
+{
+    uint64_t at = 0;
+    if (schedule->render_mode == GLPS_RENDER_CONTINUOUS || schedule->redraw_pending)
+        at = now_ns;
+    else if (schedule->redraw_at_ns != 0)
+        at = schedule->redraw_at_ns;
+    else
+        return 0;
+
+    if (schedule->visibility != GLPS_VISIBILITY_VISIBLE)
+    {
+        if (schedule->hidden_fps <= 0.0) return 0;
+
+        uint64_t hidden_at = schedule->last_frame_ns + (uint64_t)(1e9 / schedule->hidden_fps);
+        if (hidden_at > at) at = hidden_at;
+    }
+
+    return at;
+}
+
+bool glps_scheduler_wants_frame(const glps_FrameSchedule *schedule, uint64_t now_ns)
+{
+    uint64_t at = glps_scheduler_next_frame_at(schedule, now_ns);
+    return at != 0 && at <= now_ns;
+}
+
+bool glps_scheduler_set_visibility(glps_FrameSchedule *schedule, GLPS_VISIBILITY visibility)
+{
+    if (schedule->visibility == visibility) return false;
+
+    schedule->visibility = visibility;
+    // Frames held back while hidden are stale; restart pacing from now.
+    schedule->next_frame_ns = 0;
+    schedule->deferred = false;
+    return true;
+}
+
+void glps_scheduler_request_redraw(glps_FrameSchedule *schedule)
+{
+    if (schedule->render_mode == GLPS_RENDER_CONTINUOUS || schedule->redraw_pending) return;
+
+    schedule->redraw_pending = true;
+    schedule->stats.redraw_requests++;
+}
+
+void glps_scheduler_frame_done(glps_FrameSchedule *schedule, uint64_t now_ns)
+{
+    if (schedule->redraw_at_ns != 0 && schedule->redraw_at_ns <= now_ns)
+    {
+        schedule->redraw_at_ns = 0;
+        if (!schedule->redraw_pending) schedule->stats.redraw_requests++;
+    }
+    schedule->redraw_pending = false;
+    schedule->last_frame_ns = now_ns;
+    schedule->stats.frames++;
+}
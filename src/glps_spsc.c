@@ -0,0 +1,73 @@
+#include "glps_spsc.h"
+#include "utils/logger/pico_logger.h"
+
+bool glps_spsc_init(glps_SpscRing *ring, size_t element_size, size_t capacity)
+{
+    if (ring == NULL || element_size == 0 || capacity == 0) return false;
+
+    size_t rounded = 1;
+    while (rounded < capacity)
+    {
+        if (rounded > SIZE_MAX / 2 / element_size)
+        {
+            LOG_ERROR("Ring capacity %zu is too large", capacity);
+            return false;
+        }
+        rounded *= 2;
+    }
+
+    ring->buffer = (unsigned char *)malloc(rounded * element_size);
+    if (ring->buffer == NULL)
+    {
+        LOG_ERROR("Failed to allocate ring buffer");
+        return false;
+    }
+
+    ring->element_size = element_size;
+    ring->capacity = rounded;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return true;
+}
+
+void glps_spsc_destroy(glps_SpscRing *ring)
+{
+    if (ring == NULL) return;
+
+    free(ring->buffer);
+    ring->buffer = NULL;
+    ring->capacity = 0;
+}
+
+bool glps_spsc_push(glps_SpscRing *ring, const void *element)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (tail - head == ring->capacity) return false;
+
+    memcpy(ring->buffer + (tail & (ring->capacity - 1)) * ring->element_size,
+           element, ring->element_size);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool glps_spsc_pop(glps_SpscRing *ring, void *element)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head == tail) return false;
+
+    memcpy(element, ring->buffer + (head & (ring->capacity - 1)) * ring->element_size,
+           ring->element_size);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+size_t glps_spsc_size(glps_SpscRing *ring)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    return tail - head;
+}
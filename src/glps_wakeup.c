@@ -0,0 +1,53 @@
+#include "glps_wakeup.h"
+#include "utils/logger/pico_logger.h"
+
+#include <sys/eventfd.h>
+
+bool glps_wakeup_init(glps_WindowManager *wm)
+{
+    if (wm == NULL) return false;
+
+    wm->wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wm->wakeup_fd < 0)
+    {
+        LOG_ERROR("Failed to create wakeup eventfd: %s", strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+void glps_wakeup_destroy(glps_WindowManager *wm)
+{
+    if (wm == NULL || wm->wakeup_fd < 0) return;
+
+    close(wm->wakeup_fd);
+    wm->wakeup_fd = -1;
+}
+
+void glps_wakeup_post(glps_WindowManager *wm)
+{
+    if (wm == NULL || wm->wakeup_fd < 0) return;
+
+    uint64_t value = 1;
+    // EAGAIN means the counter is saturated, which is still a pending wakeup.
+    while (write(wm->wakeup_fd, &value, sizeof(value)) < 0 && errno == EINTR)
+        ;
+}
+
+void glps_wakeup_drain(glps_WindowManager *wm)
+{
+    if (wm == NULL || wm->wakeup_fd < 0) return;
+
+    uint64_t value;
+    while (read(wm->wakeup_fd, &value, sizeof(value)) < 0 && errno == EINTR)
+        ;
+}
+
+int glps_wakeup_timeout_ms(int64_t timeout_ns)
+{
+    if (timeout_ns < 0) return -1;
+    if (timeout_ns / 1000000 >= INT_MAX) return INT_MAX;
+
+    return (int)((timeout_ns + 999999) / 1000000);
+}
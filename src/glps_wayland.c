@@ -1,7 +1,21 @@
 #include <glps_egl_context.h>
 #include <glps_wayland.h>
+#include "glps_capture.h"
+#include "glps_window_index.h"
+#include "glps_window_table.h"
+#include "glps_wakeup.h"
+#include "glps_events.h"
+#include "glps_input_thread.h"
+#include "glps_latency.h"
+#include "glps_scheduler.h"
 #include "utils/logger/pico_logger.h"
 
+#include <poll.h>
+#include <sys/eventfd.h>
+
+// A frame callback unanswered for this long means the surface is not shown.
+#define FRAME_CALLBACK_STALL_NS 500000000ull
+
 void xdg_wm_base_ping(void *data, struct xdg_wm_base *xdg_wm_base,
                       uint32_t serial)
 {
@@ -25,15 +39,7 @@ glps_WaylandContext *__get_wl_context(glps_WindowManager *wm)
 
 static bool __is_valid_window_id(glps_WindowManager *wm, size_t window_id)
 {
-  if (wm == NULL || wm->windows == NULL)
-    return false;
-  if (window_id >= (size_t)MAX_WINDOWS)
-    return false;
-  if (window_id >= wm->window_count)
-    return false;
-  if (wm->windows[window_id] == NULL)
-    return false;
-  return true;
+  return glps_window_table_is_live(wm, window_id);
 }
 
 ssize_t __get_window_id_from_surface(glps_WindowManager *wm,
@@ -46,15 +52,7 @@ ssize_t __get_window_id_from_surface(glps_WindowManager *wm,
     return -1;
   }
 
-  for (size_t i = 0; i < wm->window_count; ++i)
-  {
-    if (wm->windows[i] == NULL)
-      continue;
-    if (surface == wm->windows[i]->wl_surface)
-      return i;
-  }
-
-  return -1;
+  return glps_window_index_find(wm, (uintptr_t)surface);
 }
 
 ssize_t __get_window_id_from_xdg_surface(glps_WindowManager *wm,
@@ -67,15 +65,7 @@ ssize_t __get_window_id_from_xdg_surface(glps_WindowManager *wm,
     return -1;
   }
 
-  for (size_t i = 0; i < wm->window_count; ++i)
-  {
-    if (wm->windows[i] == NULL)
-      continue;
-    if (surface == wm->windows[i]->xdg_surface)
-      return i;
-  }
-
-  return -1;
+  return glps_window_index_find(wm, (uintptr_t)surface);
 }
 
 
@@ -87,7 +77,30 @@ void __window_destroy(glps_WindowManager *wm, size_t window_id)
     return;
   }
 
-  glps_WaylandWindow *window = wm->windows[window_id];
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
+
+  glps_capture_stop(wm, window_id, NULL);
+
+  glps_window_index_remove(wm, (uintptr_t)window->wl_surface);
+  glps_window_index_remove(wm, (uintptr_t)window->xdg_surface);
+  glps_window_index_remove(wm, (uintptr_t)window->xdg_toplevel);
+
+  for (size_t i = 0; i < GLPS_PRESENT_FEEDBACK_MAX; ++i)
+  {
+    if (window->present_feedback[i] != NULL)
+    {
+      wp_presentation_feedback_destroy(window->present_feedback[i]);
+      window->present_feedback[i] = NULL;
+    }
+  }
+
+#ifdef GLPS_HAVE_TEARING_CONTROL
+  if (window->tearing_control != NULL)
+  {
+    wp_tearing_control_v1_destroy(window->tearing_control);
+    window->tearing_control = NULL;
+  }
+#endif
 
   if (window->frame_args != NULL)
   {
@@ -104,7 +117,10 @@ void __window_destroy(glps_WindowManager *wm, size_t window_id)
   if (window->egl_surface != EGL_NO_SURFACE)
   {
     if (wm->egl_ctx != NULL)
+    {
+      glps_egl_release_surface(wm, window->egl_surface);
       eglDestroySurface(wm->egl_ctx->dpy, window->egl_surface);
+    }
     window->egl_surface = EGL_NO_SURFACE;
   }
 
@@ -132,15 +148,15 @@ void __window_destroy(glps_WindowManager *wm, size_t window_id)
     window->wl_surface = NULL;
   }
 
-  free(window);
-  wm->windows[window_id] = NULL;
-
- 
-  while (wm->window_count > 0 && wm->windows[wm->window_count - 1] == NULL)
+  if (window->queue != NULL)
   {
-    wm->window_count--;
+    wl_event_queue_destroy(window->queue);
+    window->queue = NULL;
   }
 
+  glps_window_table_remove(wm, window_id);
+  free(window);
+
   if (wm->window_count == 0)
   {
     LOG_INFO("All windows destroyed. Exiting program.");
@@ -156,10 +172,13 @@ void wl_update(glps_WindowManager *wm, size_t window_id)
     return;
   }
 
-  int width  = wm->windows[window_id]->properties.width;
-  int height = wm->windows[window_id]->properties.height;
-  wl_surface_damage(wm->windows[window_id]->wl_surface, 0, 0, width, height);
-  wl_surface_commit(wm->windows[window_id]->wl_surface);
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
+  int width  = window->properties.width;
+  int height = window->properties.height;
+  glps_wl_prepare_commit(wm, window_id);
+  // Buffer coordinates stay correct with a buffer scale or transform.
+  wl_surface_damage_buffer(window->wl_surface, 0, 0, width, height);
+  wl_surface_commit(window->wl_surface);
 }
 
 ssize_t __get_window_id_from_xdg_toplevel(glps_WindowManager *wm,
@@ -172,18 +191,11 @@ ssize_t __get_window_id_from_xdg_toplevel(glps_WindowManager *wm,
     return -1;
   }
 
-  for (size_t i = 0; i < wm->window_count; ++i)
-  {
-    if (wm->windows[i] == NULL)
-      continue;
-    if (toplevel == wm->windows[i]->xdg_toplevel)
-      return i;
-  }
-
-  return -1;
+  return glps_window_index_find(wm, (uintptr_t)toplevel);
 }
 
 struct wl_callback_listener frame_callback_listener;
+struct wp_presentation_listener presentation_listener;
 
 void wl_pointer_enter(void *data, struct wl_pointer *wl_pointer,
                       uint32_t serial, struct wl_surface *surface,
@@ -365,49 +377,48 @@ void wl_pointer_frame(void *data, struct wl_pointer *wl_pointer)
     return;
   }
 
+  // Enter/leave carry no time; they are stamped on delivery.
+  uint64_t timestamp_ns = event->time != 0
+                              ? glps_latency_from_server_ms(context, event->time)
+                              : 0;
+
   if (event->event_mask & POINTER_EVENT_ENTER)
   {
-    if (context->callbacks.mouse_enter_callback)
-    {
-      context->callbacks.mouse_enter_callback(
-          wayland_context->mouse_window_id,
-          wl_fixed_to_double(event->surface_x),
-          wl_fixed_to_double(event->surface_y),
-          context->callbacks.mouse_enter_data);
-    }
+    glps_events_emit(context, &(glps_Event){
+                                  .type      = GLPS_EVENT_MOUSE_ENTER,
+                                  .window_id = wayland_context->mouse_window_id,
+                                  .mouse     = {wl_fixed_to_double(event->surface_x),
+                                                wl_fixed_to_double(event->surface_y)},
+                              });
   }
 
   if (event->event_mask & POINTER_EVENT_LEAVE)
   {
-    if (context->callbacks.mouse_leave_callback)
-    {
-      context->callbacks.mouse_leave_callback(
-          wayland_context->mouse_window_id,
-          context->callbacks.mouse_leave_data);
-    }
+    glps_events_emit(context, &(glps_Event){
+                                  .type      = GLPS_EVENT_MOUSE_LEAVE,
+                                  .window_id = wayland_context->mouse_window_id,
+                              });
   }
 
   if (event->event_mask & POINTER_EVENT_MOTION)
   {
-    if (context->callbacks.mouse_move_callback)
-    {
-      context->callbacks.mouse_move_callback(
-          wayland_context->mouse_window_id,
-          wl_fixed_to_double(event->surface_x),
-          wl_fixed_to_double(event->surface_y),
-          context->callbacks.mouse_move_data);
-    }
+    glps_events_emit(context, &(glps_Event){
+                                  .type      = GLPS_EVENT_MOUSE_MOVE,
+                                  .window_id = wayland_context->mouse_window_id,
+                                  .timestamp_ns = timestamp_ns,
+                                  .mouse     = {wl_fixed_to_double(event->surface_x),
+                                                wl_fixed_to_double(event->surface_y)},
+                              });
   }
 
   if (event->event_mask & POINTER_EVENT_BUTTON)
   {
-    if (context->callbacks.mouse_click_callback)
-    {
-      context->callbacks.mouse_click_callback(
-          wayland_context->mouse_window_id,
-          event->state == WL_POINTER_BUTTON_STATE_RELEASED ? false : true,
-          context->callbacks.mouse_click_data);
-    }
+    glps_events_emit(context, &(glps_Event){
+                                  .type      = GLPS_EVENT_MOUSE_CLICK,
+                                  .window_id = wayland_context->mouse_window_id,
+                                  .timestamp_ns = timestamp_ns,
+                                  .click     = {event->state != WL_POINTER_BUTTON_STATE_RELEASED},
+                              });
   }
 
   uint32_t axis_events = POINTER_EVENT_AXIS | POINTER_EVENT_AXIS_SOURCE |
@@ -433,30 +444,29 @@ void wl_pointer_frame(void *data, struct wl_pointer *wl_pointer)
       if (!event->axes[i].valid)
         continue;
 
-      if (context->callbacks.mouse_scroll_callback)
-      {
-        GLPS_SCROLL_AXES axe = axis_name[i];
-
-        GLPS_SCROLL_SOURCE source = GLPS_SCROLL_SOURCE_OTHER;
-        if ((event->event_mask & POINTER_EVENT_AXIS_SOURCE) &&
-            event->axis_source < axis_source_count)
-        {
-          source = axis_source[event->axis_source];
-        }
+      GLPS_SCROLL_AXES axe = axis_name[i];
 
-        double value    = event->event_mask & POINTER_EVENT_AXIS
-                              ? wl_fixed_to_double(event->axes[i].value)
-                              : 0.0;
-        int    discrete = event->event_mask & POINTER_EVENT_AXIS_DISCRETE
-                              ? event->axes[i].discrete
-                              : -1;
-        bool   is_stopped = event->event_mask & POINTER_EVENT_AXIS_STOP;
-
-        context->callbacks.mouse_scroll_callback(
-            wayland_context->mouse_window_id,
-            axe, source, value, discrete, is_stopped,
-            context->callbacks.mouse_scroll_data);
+      GLPS_SCROLL_SOURCE source = GLPS_SCROLL_SOURCE_OTHER;
+      if ((event->event_mask & POINTER_EVENT_AXIS_SOURCE) &&
+          event->axis_source < axis_source_count)
+      {
+        source = axis_source[event->axis_source];
       }
+
+      double value    = event->event_mask & POINTER_EVENT_AXIS
+                            ? wl_fixed_to_double(event->axes[i].value)
+                            : 0.0;
+      int    discrete = event->event_mask & POINTER_EVENT_AXIS_DISCRETE
+                            ? event->axes[i].discrete
+                            : -1;
+      bool   is_stopped = event->event_mask & POINTER_EVENT_AXIS_STOP;
+
+      glps_events_emit(context, &(glps_Event){
+                                    .type      = GLPS_EVENT_MOUSE_SCROLL,
+                                    .window_id = wayland_context->mouse_window_id,
+                                    .timestamp_ns = timestamp_ns,
+                                    .scroll    = {axe, source, value, discrete, is_stopped},
+                                });
     }
   }
 
@@ -552,11 +562,10 @@ void wl_keyboard_enter(void *data, struct wl_keyboard *wl_keyboard,
   context->keyboard_serial    = serial;
   context->keyboard_window_id = (size_t)window_id;
 
-  if (wm->callbacks.keyboard_enter_callback != NULL)
-  {
-    wm->callbacks.keyboard_enter_callback(context->keyboard_window_id,
-                                          wm->callbacks.keyboard_enter_data);
-  }
+  glps_events_emit(wm, &(glps_Event){
+                           .type      = GLPS_EVENT_KEYBOARD_ENTER,
+                           .window_id = context->keyboard_window_id,
+                       });
 }
 
 void wl_keyboard_key(void *data, struct wl_keyboard *wl_keyboard,
@@ -589,16 +598,12 @@ void wl_keyboard_key(void *data, struct wl_keyboard *wl_keyboard,
   if (utf8_len <= 0 || utf8[0] == '\0')
     utf8[0] = '\0';
 
-  glps_WindowManager *wm = (glps_WindowManager *)data;
-  if (wm->callbacks.keyboard_callback != NULL)
-  {
-    wm->callbacks.keyboard_callback(
-        context->keyboard_window_id,
-        state == WL_KEYBOARD_KEY_STATE_PRESSED ? true : false,
-        (utf8[0] != '\0' ? utf8 : name),
-        keycode,
-        wm->callbacks.keyboard_data);
-  }
+  glps_events_emit_key((glps_WindowManager *)data,
+                       context->keyboard_window_id,
+                       state == WL_KEYBOARD_KEY_STATE_PRESSED,
+                       (utf8[0] != '\0' ? utf8 : name),
+                       keycode,
+                       glps_latency_from_server_ms(data, time));
 }
 
 void wl_keyboard_leave(void *data, struct wl_keyboard *wl_keyboard,
@@ -608,11 +613,10 @@ void wl_keyboard_leave(void *data, struct wl_keyboard *wl_keyboard,
   if (wm == NULL || wm->wayland_ctx == NULL)
     return;
 
-  if (wm->callbacks.keyboard_leave_callback != NULL)
-  {
-    wm->callbacks.keyboard_leave_callback(wm->wayland_ctx->keyboard_window_id,
-                                          wm->callbacks.keyboard_leave_data);
-  }
+  glps_events_emit(wm, &(glps_Event){
+                           .type      = GLPS_EVENT_KEYBOARD_LEAVE,
+                           .window_id = wm->wayland_ctx->keyboard_window_id,
+                       });
 }
 
 void wl_keyboard_modifiers(void *data, struct wl_keyboard *wl_keyboard,
@@ -728,6 +732,7 @@ void wl_touch_up(void *data, struct wl_touch *wl_touch, uint32_t serial,
     return;
 
   point->event_mask |= TOUCH_EVENT_UP;
+  wm->touch_event.time = time;
 }
 
 void wl_touch_motion(void *data, struct wl_touch *wl_touch, uint32_t time,
@@ -835,31 +840,24 @@ void wl_touch_frame(void *data, struct wl_touch *wl_touch)
     bool had_down = point->event_mask & TOUCH_EVENT_DOWN;
     bool had_up   = point->event_mask & TOUCH_EVENT_UP;
 
+    glps_Event touch_event = {
+        .type      = GLPS_EVENT_TOUCH,
+        .window_id = context->touch_window_id,
+        .timestamp_ns = glps_latency_from_server_ms(wm, touch->time),
+        .touch     = {point->id, px, py, !had_up, major, minor, orientation},
+    };
+
     if (had_down && had_up)
     {
-      if (wm->callbacks.touch_callback)
-      {
-        wm->callbacks.touch_callback(
-            context->touch_window_id, point->id, px, py,
-            true, major, minor, orientation,
-            wm->callbacks.touch_data);
-        wm->callbacks.touch_callback(
-            context->touch_window_id, point->id, px, py,
-            false, major, minor, orientation,
-            wm->callbacks.touch_data);
-      }
+      touch_event.touch.state = true;
+      glps_events_emit(wm, &touch_event);
+      touch_event.touch.state = false;
+      glps_events_emit(wm, &touch_event);
       point->valid = false;
     }
     else
     {
-      bool is_down = had_up ? false : true;
-      if (wm->callbacks.touch_callback)
-      {
-        wm->callbacks.touch_callback(
-            context->touch_window_id, point->id, px, py,
-            is_down, major, minor, orientation,
-            wm->callbacks.touch_data);
-      }
+      glps_events_emit(wm, &touch_event);
       if (had_up)
         point->valid = false;
     }
@@ -878,23 +876,26 @@ struct wl_touch_listener wl_touch_listener = {
     .orientation = wl_touch_orientation,
 };
 
-void wl_seat_capabilities(void *data, struct wl_seat *wl_seat,
-                           uint32_t capabilities)
+// Binds the seat devices the compositor offers and the application observes,
+// releasing the others so the compositor stops sending their events.
+static void __apply_seat_capabilities(glps_WindowManager *wm)
 {
-  glps_WindowManager  *context = (glps_WindowManager *)data;
-  if (context == NULL)
+  glps_WaylandContext *ctx = __get_wl_context(wm);
+  if (ctx == NULL || ctx->wl_seat == NULL)
     return;
 
-  glps_WaylandContext *ctx = __get_wl_context(context);
-  if (ctx == NULL)
-    return;
+  struct wl_seat *wl_seat      = ctx->wl_seat;
+  uint32_t        capabilities = ctx->seat_capabilities;
+  unsigned int    interest     = glps_events_interest(wm);
 
-  bool have_pointer = capabilities & WL_SEAT_CAPABILITY_POINTER;
+  bool have_pointer = (capabilities & WL_SEAT_CAPABILITY_POINTER) &&
+                      (interest & (GLPS_EVENT_INTEREST_POINTER_MOTION |
+                                   GLPS_EVENT_INTEREST_POINTER_BUTTON));
   if (have_pointer && ctx->wl_pointer == NULL)
   {
     ctx->wl_pointer = wl_seat_get_pointer(wl_seat);
     if (ctx->wl_pointer != NULL)
-      wl_pointer_add_listener(ctx->wl_pointer, &wl_pointer_listener, data);
+      wl_pointer_add_listener(ctx->wl_pointer, &wl_pointer_listener, wm);
     else
       LOG_ERROR("wl_seat_capabilities: failed to get wl_pointer");
   }
@@ -904,12 +905,13 @@ void wl_seat_capabilities(void *data, struct wl_seat *wl_seat,
     ctx->wl_pointer = NULL;
   }
 
-  bool have_keyboard = capabilities & WL_SEAT_CAPABILITY_KEYBOARD;
+  bool have_keyboard = (capabilities & WL_SEAT_CAPABILITY_KEYBOARD) &&
+                       (interest & GLPS_EVENT_INTEREST_KEYBOARD);
   if (have_keyboard && ctx->wl_keyboard == NULL)
   {
     ctx->wl_keyboard = wl_seat_get_keyboard(wl_seat);
     if (ctx->wl_keyboard != NULL)
-      wl_keyboard_add_listener(ctx->wl_keyboard, &wl_keyboard_listener, data);
+      wl_keyboard_add_listener(ctx->wl_keyboard, &wl_keyboard_listener, wm);
     else
       LOG_ERROR("wl_seat_capabilities: failed to get wl_keyboard");
   }
@@ -919,12 +921,13 @@ void wl_seat_capabilities(void *data, struct wl_seat *wl_seat,
     ctx->wl_keyboard = NULL;
   }
 
-  bool have_touch = capabilities & WL_SEAT_CAPABILITY_TOUCH;
+  bool have_touch = (capabilities & WL_SEAT_CAPABILITY_TOUCH) &&
+                    (interest & GLPS_EVENT_INTEREST_TOUCH);
   if (have_touch && ctx->wl_touch == NULL)
   {
     ctx->wl_touch = wl_seat_get_touch(wl_seat);
     if (ctx->wl_touch != NULL)
-      wl_touch_add_listener(ctx->wl_touch, &wl_touch_listener, data);
+      wl_touch_add_listener(ctx->wl_touch, &wl_touch_listener, wm);
     else
       LOG_ERROR("wl_seat_capabilities: failed to get wl_touch");
   }
@@ -935,6 +938,38 @@ void wl_seat_capabilities(void *data, struct wl_seat *wl_seat,
   }
 }
 
+void wl_seat_capabilities(void *data, struct wl_seat *wl_seat,
+                           uint32_t capabilities)
+{
+  glps_WindowManager  *context = (glps_WindowManager *)data;
+  if (context == NULL)
+    return;
+
+  glps_WaylandContext *ctx = __get_wl_context(context);
+  if (ctx == NULL)
+    return;
+
+  ctx->seat_capabilities = capabilities;
+  __apply_seat_capabilities(context);
+}
+
+void glps_wl_update_seat_capabilities(glps_WindowManager *wm)
+{
+  if (wm == NULL || wm->wayland_ctx == NULL)
+    return;
+
+  // The seat objects belong to the input thread while it runs.
+  if (wm->input_thread != NULL)
+  {
+    atomic_store(&wm->input_thread->seat_dirty, true);
+    glps_wl_input_thread_wake(wm);
+    return;
+  }
+
+  __apply_seat_capabilities(wm);
+  wl_display_flush(wm->wayland_ctx->wl_display);
+}
+
 void wl_seat_name(void *data, struct wl_seat *wl_seat, const char *name)
 {
   (void)data;
@@ -947,6 +982,149 @@ struct wl_seat_listener wl_seat_listener = {
     .name         = wl_seat_name,
 };
 
+static glps_WaylandOutput *__find_output(glps_WaylandContext *ctx, struct wl_output *wl_output)
+{
+  for (size_t i = 0; i < ctx->output_count; ++i)
+  {
+    if (ctx->outputs[i].wl_output == wl_output)
+      return &ctx->outputs[i];
+  }
+  return NULL;
+}
+
+// Re-schedules every window shown on an output after its mode changed. The
+// schedule of a window with its own queue belongs to the thread dispatching
+// it, which picks the change up in __apply_pending_refresh. Called with
+// shared_lock held.
+static void __update_output_windows(glps_WindowManager *wm, const glps_WaylandOutput *output)
+{
+  for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
+  {
+    if (glps_window_table_id_at(wm, slot) < 0)
+      continue;
+
+    glps_WaylandWindow *window = wm->windows[slot];
+    if (window->output != output->wl_output)
+      continue;
+
+    if (window->queue != NULL)
+      window->pending_refresh_ns = output->refresh_ns;
+    else
+      glps_scheduler_set_refresh(&window->schedule, output->refresh_ns);
+  }
+}
+
+static void __apply_pending_refresh(glps_WindowManager *wm, glps_WaylandWindow *window)
+{
+  glps_thread_mutex_lock(&wm->shared_lock);
+  uint64_t refresh_ns        = window->pending_refresh_ns;
+  window->pending_refresh_ns = 0;
+  glps_thread_mutex_unlock(&wm->shared_lock);
+
+  if (refresh_ns != 0)
+    glps_scheduler_set_refresh(&window->schedule, refresh_ns);
+}
+
+void wl_output_geometry(void *data, struct wl_output *wl_output, int32_t x, int32_t y,
+                        int32_t physical_width, int32_t physical_height, int32_t subpixel,
+                        const char *make, const char *model, int32_t transform)
+{
+  (void)data;
+  (void)wl_output;
+  (void)x;
+  (void)y;
+  (void)physical_width;
+  (void)physical_height;
+  (void)subpixel;
+  (void)make;
+  (void)model;
+  (void)transform;
+}
+
+void wl_output_mode(void *data, struct wl_output *wl_output, uint32_t flags,
+                    int32_t width, int32_t height, int32_t refresh)
+{
+  (void)width;
+  (void)height;
+
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  if (!(flags & WL_OUTPUT_MODE_CURRENT) || refresh <= 0)
+    return;
+
+  glps_thread_mutex_lock(&wm->shared_lock);
+  glps_WaylandOutput *output = __find_output(wm->wayland_ctx, wl_output);
+  if (output != NULL)
+  {
+    // Refresh is reported in mHz.
+    output->refresh_ns = 1000000000000ull / (uint64_t)refresh;
+    __update_output_windows(wm, output);
+  }
+  glps_thread_mutex_unlock(&wm->shared_lock);
+}
+
+void wl_output_done(void *data, struct wl_output *wl_output)
+{
+  (void)data;
+  (void)wl_output;
+}
+
+void wl_output_scale(void *data, struct wl_output *wl_output, int32_t factor)
+{
+  (void)data;
+  (void)wl_output;
+  (void)factor;
+}
+
+struct wl_output_listener wl_output_listener = {
+    .geometry = wl_output_geometry,
+    .mode     = wl_output_mode,
+    .done     = wl_output_done,
+    .scale    = wl_output_scale,
+};
+
+void wl_surface_enter(void *data, struct wl_surface *wl_surface,
+                      struct wl_output *wl_output)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  ssize_t window_id = __get_window_id_from_surface(wm, wl_surface);
+  if (window_id < 0)
+    return;
+
+  // Runs on the window's queue thread, if it has one, while the main thread
+  // may be adding or removing outputs.
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
+  glps_thread_mutex_lock(&wm->shared_lock);
+  glps_WaylandOutput *output = __find_output(wm->wayland_ctx, wl_output);
+  uint64_t refresh_ns        = output != NULL ? output->refresh_ns : 0;
+  window->output             = wl_output;
+  window->pending_refresh_ns = 0;
+  glps_thread_mutex_unlock(&wm->shared_lock);
+
+  if (output != NULL)
+    glps_scheduler_set_refresh(&window->schedule, refresh_ns);
+}
+
+void wl_surface_leave(void *data, struct wl_surface *wl_surface,
+                      struct wl_output *wl_output)
+{
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  ssize_t window_id = __get_window_id_from_surface(wm, wl_surface);
+  if (window_id < 0)
+    return;
+
+  // Spanning windows keep the output they entered last until it is left.
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
+  glps_thread_mutex_lock(&wm->shared_lock);
+  if (window->output == wl_output)
+    window->output = NULL;
+  glps_thread_mutex_unlock(&wm->shared_lock);
+}
+
+struct wl_surface_listener wl_surface_listener = {
+    .enter = wl_surface_enter,
+    .leave = wl_surface_leave,
+};
+
 void handle_global(void *data, struct wl_registry *registry, uint32_t id,
                    const char *interface, uint32_t version)
 {
@@ -970,13 +1148,55 @@ void handle_global(void *data, struct wl_registry *registry, uint32_t id,
   }
   else if (strcmp(interface, "xdg_wm_base") == 0)
   {
+    // Version 6 adds the suspended state; never ask for more than the
+    // generated protocol code knows.
+    uint32_t bind_version = (uint32_t)xdg_wm_base_interface.version;
+    if (bind_version > 6) bind_version = 6;
+    if (version < bind_version) bind_version = version;
     s->xdg_wm_base = wl_registry_bind(registry, id,
-                                       &xdg_wm_base_interface, 1);
+                                       &xdg_wm_base_interface, bind_version);
     if (!s->xdg_wm_base)
       LOG_ERROR("Failed to bind xdg_wm_base.");
     else
       LOG_INFO("Successfully bound xdg_wm_base.");
   }
+  else if (strcmp(interface, wp_presentation_interface.name) == 0)
+  {
+    s->wp_presentation = wl_registry_bind(registry, id, &wp_presentation_interface, 1);
+    if (!s->wp_presentation)
+      LOG_ERROR("Failed to bind wp_presentation.");
+    else
+      wp_presentation_add_listener(s->wp_presentation, &presentation_listener, data);
+  }
+#ifdef GLPS_HAVE_TEARING_CONTROL
+  else if (strcmp(interface, wp_tearing_control_manager_v1_interface.name) == 0)
+  {
+    s->tearing_control_manager =
+        wl_registry_bind(registry, id, &wp_tearing_control_manager_v1_interface, 1);
+    if (!s->tearing_control_manager)
+      LOG_ERROR("Failed to bind wp_tearing_control_manager_v1.");
+  }
+#endif
+  else if (strcmp(interface, wl_output_interface.name) == 0)
+  {
+    if (s->output_count == GLPS_MAX_OUTPUTS)
+    {
+      LOG_WARNING("Too many outputs, ignoring output %u.", id);
+      return;
+    }
+
+    struct wl_output *output =
+        wl_registry_bind(registry, id, &wl_output_interface, version < 2 ? version : 2);
+    if (!output)
+    {
+      LOG_ERROR("Failed to bind wl_output.");
+      return;
+    }
+    glps_thread_mutex_lock(&context->shared_lock);
+    s->outputs[s->output_count++] = (glps_WaylandOutput){.wl_output = output, .name = id};
+    glps_thread_mutex_unlock(&context->shared_lock);
+    wl_output_add_listener(output, &wl_output_listener, data);
+  }
   else if (strcmp(interface, "wl_shm") == 0)
   {
     s->wl_shm = wl_registry_bind(registry, id, &wl_shm_interface, 1);
@@ -1007,9 +1227,31 @@ void handle_global(void *data, struct wl_registry *registry, uint32_t id,
 void handle_global_remove(void *data, struct wl_registry *registry,
                           uint32_t name)
 {
-  (void)data;
   (void)registry;
-  (void)name;
+
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  if (wm == NULL || wm->wayland_ctx == NULL)
+    return;
+
+  glps_WaylandContext *ctx = wm->wayland_ctx;
+  glps_thread_mutex_lock(&wm->shared_lock);
+  for (size_t i = 0; i < ctx->output_count; ++i)
+  {
+    if (ctx->outputs[i].name != name)
+      continue;
+
+    struct wl_output *wl_output = ctx->outputs[i].wl_output;
+    for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
+    {
+      if (glps_window_table_id_at(wm, slot) >= 0 && wm->windows[slot]->output == wl_output)
+        wm->windows[slot]->output = NULL;
+    }
+
+    wl_output_destroy(wl_output);
+    ctx->outputs[i] = ctx->outputs[--ctx->output_count];
+    break;
+  }
+  glps_thread_mutex_unlock(&wm->shared_lock);
 }
 
 struct wl_registry_listener registry_listener = {
@@ -1017,6 +1259,21 @@ struct wl_registry_listener registry_listener = {
     .global_remove = handle_global_remove,
 };
 
+// Suspended toplevels are hidden; surfaces the compositor stopped sending
+// frame callbacks for are treated as occluded.
+static void __update_visibility(glps_WindowManager *wm, size_t window_id, uint64_t now)
+{
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
+
+  GLPS_VISIBILITY visibility = GLPS_VISIBILITY_VISIBLE;
+  if (window->suspended)
+    visibility = GLPS_VISIBILITY_HIDDEN;
+  else if (window->frame_callback != NULL && now > window->frame_requested_ns + FRAME_CALLBACK_STALL_NS)
+    visibility = GLPS_VISIBILITY_OCCLUDED;
+
+  glps_events_emit_visibility(wm, window_id, visibility, now);
+}
+
 static void request_frame(glps_WaylandWindow *window, frame_callback_args *args)
 {
   if (window == NULL || args == NULL)
@@ -1032,14 +1289,193 @@ static void request_frame(glps_WaylandWindow *window, frame_callback_args *args)
               args->window_id);
     return;
   }
+  window->frame_requested_ns = glps_latency_now_ns();
 
   wl_callback_add_listener(
       window->frame_callback,
       &frame_callback_listener,
       args
   );
+}
+
+static void __release_present_feedback(glps_WaylandWindow *window,
+                                       struct wp_presentation_feedback *feedback)
+{
+  for (size_t i = 0; i < GLPS_PRESENT_FEEDBACK_MAX; ++i)
+  {
+    if (window->present_feedback[i] == feedback)
+      window->present_feedback[i] = NULL;
+  }
+  wp_presentation_feedback_destroy(feedback);
+}
+
+void presentation_feedback_sync_output(void *data,
+                                       struct wp_presentation_feedback *feedback,
+                                       struct wl_output *output)
+{
+  (void)data;
+  (void)feedback;
+  (void)output;
+}
+
+void presentation_feedback_presented(void *data,
+                                     struct wp_presentation_feedback *feedback,
+                                     uint32_t tv_sec_hi, uint32_t tv_sec_lo,
+                                     uint32_t tv_nsec, uint32_t refresh,
+                                     uint32_t seq_hi, uint32_t seq_lo,
+                                     uint32_t flags)
+{
+  // Pending feedback is destroyed with its window, so args is still valid.
+  frame_callback_args *args   = (frame_callback_args *)data;
+  glps_WaylandWindow  *window = args->wm->windows[GLPS_WINDOW_SLOT(args->window_id)];
+  __release_present_feedback(window, feedback);
+
+  uint64_t present_ns =
+      (((uint64_t)tv_sec_hi << 32) | tv_sec_lo) * 1000000000ull + tv_nsec;
+
+  // Feedback uses the compositor's clock; move it onto CLOCK_MONOTONIC.
+  clockid_t clock = (clockid_t)args->wm->wayland_ctx->presentation_clock;
+  if (clock != CLOCK_MONOTONIC)
+  {
+    struct timespec mono, other;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(clock, &other);
+    int64_t offset_ns = ((int64_t)mono.tv_sec - other.tv_sec) * 1000000000ll +
+                        ((int64_t)mono.tv_nsec - other.tv_nsec);
+    present_ns = (uint64_t)((int64_t)present_ns + offset_ns);
+  }
+
+  window->last_present = (glps_PresentFeedback){
+      .present_ns = present_ns,
+      .refresh_ns = refresh,
+      .msc        = ((uint64_t)seq_hi << 32) | seq_lo,
+      .flags      = flags,
+  };
+  glps_events_dispatch_present(args->wm, args->window_id, &window->last_present);
+}
+
+void presentation_feedback_discarded(void *data,
+                                     struct wp_presentation_feedback *feedback)
+{
+  frame_callback_args *args   = (frame_callback_args *)data;
+  glps_WaylandWindow  *window = args->wm->windows[GLPS_WINDOW_SLOT(args->window_id)];
+  __release_present_feedback(window, feedback);
+
+  glps_events_dispatch_present(args->wm, args->window_id,
+                               &(glps_PresentFeedback){.discarded = true});
+}
+
+struct wp_presentation_feedback_listener presentation_feedback_listener = {
+    .sync_output = presentation_feedback_sync_output,
+    .presented   = presentation_feedback_presented,
+    .discarded   = presentation_feedback_discarded,
+};
+
+void presentation_clock_id(void *data, struct wp_presentation *presentation,
+                           uint32_t clock_id)
+{
+  (void)presentation;
+
+  glps_WindowManager *wm = (glps_WindowManager *)data;
+  if (wm != NULL && wm->wayland_ctx != NULL)
+    wm->wayland_ctx->presentation_clock = clock_id;
+}
+
+struct wp_presentation_listener presentation_listener = {
+    .clock_id = presentation_clock_id,
+};
+
+void glps_wl_prepare_commit(glps_WindowManager *wm, size_t window_id)
+{
+  if (!__is_valid_window_id(wm, window_id))
+    return;
+
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
+
+  // Re-armed before every commit so the compositor paces the next frame.
+  request_frame(window, window->frame_args);
+
+  if (wm->wayland_ctx->wp_presentation == NULL)
+    return;
+
+  for (size_t i = 0; i < GLPS_PRESENT_FEEDBACK_MAX; ++i)
+  {
+    if (window->present_feedback[i] != NULL)
+      continue;
+
+    struct wp_presentation_feedback *feedback =
+        wp_presentation_feedback(wm->wayland_ctx->wp_presentation, window->wl_surface);
+    if (feedback == NULL)
+      return;
+
+    if (window->queue != NULL)
+      wl_proxy_set_queue((struct wl_proxy *)feedback, window->queue);
+    wp_presentation_feedback_add_listener(feedback, &presentation_feedback_listener,
+                                          window->frame_args);
+    window->present_feedback[i] = feedback;
+    return;
+  }
+}
 
-  LOG_INFO("Frame callback set for window id: %zu", args->window_id);
+void glps_wl_window_set_present_mode(glps_WindowManager *wm, size_t window_id)
+{
+  if (!__is_valid_window_id(wm, window_id))
+    return;
+
+#ifdef GLPS_HAVE_TEARING_CONTROL
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
+  bool tearing = window->present.mode == GLPS_PRESENT_MODE_TEARING;
+
+  if (wm->wayland_ctx->tearing_control_manager == NULL)
+  {
+    if (tearing)
+      LOG_INFO("Compositor lacks wp_tearing_control_v1, presenting without tearing.");
+    return;
+  }
+  if (window->tearing_control == NULL)
+  {
+    if (!tearing)
+      return;
+    window->tearing_control = wp_tearing_control_manager_v1_get_tearing_control(
+        wm->wayland_ctx->tearing_control_manager, window->wl_surface);
+    if (window->tearing_control == NULL)
+      return;
+  }
+
+  // Double-buffered, takes effect with the next commit.
+  wp_tearing_control_v1_set_presentation_hint(
+      window->tearing_control, tearing ? WP_TEARING_CONTROL_V1_PRESENTATION_HINT_ASYNC
+                                       : WP_TEARING_CONTROL_V1_PRESENTATION_HINT_VSYNC);
+#else
+  if (wm->windows[GLPS_WINDOW_SLOT(window_id)]->present.mode == GLPS_PRESENT_MODE_TEARING)
+    LOG_INFO("Built without tearing-control, presenting without tearing.");
+#endif
+}
+
+// Resizes the EGL window in place; the new size takes effect with the next
+// buffer, so the surface and its context binding are kept.
+static void __apply_resize(glps_WindowManager *wm, size_t window_id)
+{
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
+  if (!window->resize.pending)
+    return;
+
+  window->properties.width  = window->resize.pending_width;
+  window->properties.height = window->resize.pending_height;
+  if (window->egl_window != NULL)
+    wl_egl_window_resize(window->egl_window, window->properties.width,
+                         window->properties.height, 0, 0);
+  glps_events_flush_resize(wm, window_id, &window->resize);
+}
+
+static void __apply_resizes(glps_WindowManager *wm, struct wl_event_queue *queue)
+{
+  for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
+  {
+    ssize_t window_id = glps_window_table_id_at(wm, slot);
+    if (window_id >= 0 && ((glps_WaylandWindow *)wm->windows[slot])->queue == queue)
+      __apply_resize(wm, (size_t)window_id);
+  }
 }
 
 void frame_callback_done(void *data, struct wl_callback *callback,
@@ -1062,7 +1498,7 @@ void frame_callback_done(void *data, struct wl_callback *callback,
     return;
   }
 
-  glps_WaylandWindow *window = args->wm->windows[args->window_id];
+  glps_WaylandWindow *window = args->wm->windows[GLPS_WINDOW_SLOT(args->window_id)];
 
   if (callback)
     wl_callback_destroy(callback);
@@ -1070,12 +1506,132 @@ void frame_callback_done(void *data, struct wl_callback *callback,
  
   if (window->frame_callback == callback)
     window->frame_callback = NULL;
+  __update_visibility(args->wm, args->window_id, glps_latency_now_ns());
+
+  // Uncapped windows are updated on every dispatch pass instead, idle
+  // on-demand windows not at all, and frames requested ahead of a lower
+  // target rate wait for __run_scheduled_frames.
+  glps_FrameSchedule *schedule = &window->schedule;
+  uint64_t now = glps_latency_now_ns();
+  if (glps_scheduler_interval_ns(schedule) == 0 || !glps_scheduler_wants_frame(schedule, now))
+    return;
+
+  if (schedule->target_fps > 0.0 && !glps_scheduler_is_due(schedule, now))
+  {
+    schedule->deferred = true;
+    return;
+  }
+
+  glps_scheduler_advance(schedule, now);
+  __apply_resize(args->wm, args->window_id);
+  glps_events_dispatch_frame(args->wm, args->window_id);
+}
+
+// Runs the frames the compositor will not ask for: uncapped windows,
+// deferred windows whose deadline has passed and on-demand windows with a
+// redraw pending and no frame callback outstanding. With a queue, only
+// windows dispatched through it are considered. The window already current
+// goes first, saving a context switch per pass.
+static void __run_scheduled_frames(glps_WindowManager *wm, struct wl_event_queue *queue)
+{
+  if (wm->callbacks.window_frame_update_callback == NULL)
+    return;
 
-  if (args->wm->callbacks.window_frame_update_callback)
+  uint64_t now = glps_latency_now_ns();
+  size_t capacity = glps_window_table_capacity(wm);
+  ssize_t current = glps_egl_current_window(wm);
+  size_t first = current >= 0 ? GLPS_WINDOW_SLOT(current) : 0;
+  for (size_t i = 0; i < capacity; ++i)
   {
-    args->wm->callbacks.window_frame_update_callback(
-        args->window_id, args->wm->callbacks.window_frame_update_data);
+    size_t slot = (first + i) % capacity;
+    ssize_t window_id = glps_window_table_id_at(wm, slot);
+    if (window_id < 0)
+      continue;
+
+    glps_WaylandWindow *window = wm->windows[slot];
+    if (window->queue != queue)
+      continue;
+
+    glps_FrameSchedule *schedule = &window->schedule;
+    bool due = glps_scheduler_interval_ns(schedule) == 0 ||
+               (schedule->deferred && schedule->next_frame_ns <= now);
+    if (schedule->render_mode == GLPS_RENDER_ON_DEMAND)
+      due = glps_scheduler_wants_frame(schedule, now) &&
+            (due || (!schedule->deferred && window->frame_callback == NULL));
+
+    // Hidden surfaces get no frame callbacks, so their hidden rate runs here.
+    __update_visibility(wm, (size_t)window_id, now);
+    if (schedule->visibility != GLPS_VISIBILITY_VISIBLE)
+      due = glps_scheduler_wants_frame(schedule, now);
+    if (!due)
+      continue;
+
+    glps_scheduler_advance(schedule, now);
+    glps_events_dispatch_frame(wm, (size_t)window_id);
+  }
+}
+
+// Shortens a wait so that deferred frames and redraw timers of the windows
+// on queue (NULL for the default queue) run on time; 0 if one of them has a
+// frame to run right away.
+static int64_t __scheduled_timeout_ns(glps_WindowManager *wm, struct wl_event_queue *queue,
+                                      int64_t timeout_ns)
+{
+  if (wm->callbacks.window_frame_update_callback == NULL)
+    return timeout_ns;
+
+  uint64_t now = glps_latency_now_ns();
+  for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
+  {
+    if (glps_window_table_id_at(wm, slot) < 0)
+      continue;
+
+    glps_WaylandWindow *window = wm->windows[slot];
+    if (window->queue != queue)
+      continue;
+
+    glps_FrameSchedule *schedule = &window->schedule;
+    uint64_t deadline            = 0;
+    if (schedule->visibility != GLPS_VISIBILITY_VISIBLE)
+    {
+      deadline = glps_scheduler_next_frame_at(schedule, now);
+    }
+    else if (schedule->render_mode == GLPS_RENDER_ON_DEMAND)
+    {
+      if (!glps_scheduler_wants_frame(schedule, now))
+        deadline = glps_scheduler_next_frame_at(schedule, now);
+      else if (glps_scheduler_interval_ns(schedule) == 0 ||
+               (!schedule->deferred && window->frame_callback == NULL))
+        return 0;
+      else if (schedule->deferred)
+        deadline = schedule->next_frame_ns;
+    }
+    else if (glps_scheduler_interval_ns(schedule) == 0)
+    {
+      return 0;
+    }
+    else if (schedule->deferred)
+    {
+      deadline = schedule->next_frame_ns;
+    }
+
+    // Wake up to notice when the compositor stops answering frame callbacks.
+    if (schedule->visibility == GLPS_VISIBILITY_VISIBLE && window->frame_callback != NULL)
+    {
+      uint64_t stall_at = window->frame_requested_ns + FRAME_CALLBACK_STALL_NS;
+      if (deadline == 0 || stall_at < deadline)
+        deadline = stall_at;
+    }
+
+    if (deadline == 0)
+      continue;
+
+    int64_t remaining = deadline > now ? (int64_t)(deadline - now) : 0;
+    if (timeout_ns < 0 || remaining < timeout_ns)
+      timeout_ns = remaining;
   }
+
+  return timeout_ns;
 }
 
 struct wl_callback_listener frame_callback_listener = {
@@ -1086,8 +1642,6 @@ void handle_toplevel_configure(void *data, struct xdg_toplevel *toplevel,
                                int32_t width, int32_t height,
                                struct wl_array *states)
 {
-  (void)states;
-
   glps_WindowManager *wm = (glps_WindowManager *)data;
   if (wm == NULL)
     return;
@@ -1099,25 +1653,27 @@ void handle_toplevel_configure(void *data, struct xdg_toplevel *toplevel,
   if (!__is_valid_window_id(wm, (size_t)window_id))
     return;
 
-  glps_WaylandWindow *window = wm->windows[window_id];
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
 
-  if (width != 0 && height != 0)
+  // XDG_TOPLEVEL_STATE_SUSPENDED needs wayland-protocols 1.32.
+#ifdef XDG_TOPLEVEL_STATE_SUSPENDED_SINCE_VERSION
+  bool suspended = false;
+  uint32_t *state;
+  wl_array_for_each(state, states)
   {
-    window->properties.height = height;
-    window->properties.width  = width;
-    if (window->egl_window != NULL)
-      wl_egl_window_resize(window->egl_window, width, height, 0, 0);
+    if (*state == XDG_TOPLEVEL_STATE_SUSPENDED)
+      suspended = true;
   }
+  window->suspended = suspended;
+#else
+  (void)states;
+#endif
+  __update_visibility(wm, (size_t)window_id, glps_latency_now_ns());
 
-  if (wm->callbacks.window_resize_callback)
-  {
-    wm->callbacks.window_resize_callback(window_id,
-                                         window->properties.width,
-                                         window->properties.height,
-                                         wm->callbacks.window_resize_data);
-  }
-  if (window->egl_window != NULL)
-    wl_update(wm, (size_t)window_id);
+  // Applied by __apply_resize before the next frame, so an interactive
+  // resize reaches the application once per frame.
+  if (width != 0 && height != 0)
+    glps_events_queue_resize(wm, (size_t)window_id, &window->resize, width, height);
 }
 
 void handle_toplevel_close(void *data, struct xdg_toplevel *toplevel)
@@ -1136,11 +1692,10 @@ void handle_toplevel_close(void *data, struct xdg_toplevel *toplevel)
     return;
   }
 
-  if (wm->callbacks.window_close_callback)
-  {
-    wm->callbacks.window_close_callback((size_t)window_id,
-                                        wm->callbacks.window_close_data);
-  }
+  glps_events_emit(wm, &(glps_Event){
+                           .type      = GLPS_EVENT_WINDOW_CLOSE,
+                           .window_id = (size_t)window_id,
+                       });
 }
 
 void handle_toplevel_configure_bounds(void *data, struct xdg_toplevel *toplevel,
@@ -1193,7 +1748,7 @@ void xdg_surface_configure(void *data, struct xdg_surface *xdg_surface,
   if (!__is_valid_window_id(wm, (size_t)window_id))
     return;
 
-  wm->windows[(size_t)window_id]->serial = serial;
+  wm->windows[GLPS_WINDOW_SLOT(window_id)]->serial = serial;
 }
 
 struct xdg_surface_listener xdg_surface_listener = {
@@ -1207,15 +1762,15 @@ static void _cleanup_wl(glps_WindowManager *wm)
 
   if (wm->windows != NULL)
   {
-    for (size_t i = 0; i < wm->window_count; ++i)
+    for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
     {
-      if (wm->windows[i])
-        __window_destroy(wm, i);
+      ssize_t window_id = glps_window_table_id_at(wm, slot);
+      if (window_id >= 0)
+        __window_destroy(wm, (size_t)window_id);
     }
-    free(wm->windows);
-    wm->windows = NULL;
   }
-  wm->window_count = 0;
+  glps_window_table_destroy(wm);
+  glps_window_index_clear(wm);
 
   if (wm->wayland_ctx != NULL)
   {
@@ -1229,6 +1784,21 @@ static void _cleanup_wl(glps_WindowManager *wm)
       xdg_wm_base_destroy(wm->wayland_ctx->xdg_wm_base);
       wm->wayland_ctx->xdg_wm_base = NULL;
     }
+    if (wm->wayland_ctx->wp_presentation != NULL)
+    {
+      wp_presentation_destroy(wm->wayland_ctx->wp_presentation);
+      wm->wayland_ctx->wp_presentation = NULL;
+    }
+#ifdef GLPS_HAVE_TEARING_CONTROL
+    if (wm->wayland_ctx->tearing_control_manager != NULL)
+    {
+      wp_tearing_control_manager_v1_destroy(wm->wayland_ctx->tearing_control_manager);
+      wm->wayland_ctx->tearing_control_manager = NULL;
+    }
+#endif
+    for (size_t i = 0; i < wm->wayland_ctx->output_count; ++i)
+      wl_output_destroy(wm->wayland_ctx->outputs[i].wl_output);
+    wm->wayland_ctx->output_count = 0;
     if (wm->wayland_ctx->wl_compositor != NULL)
     {
       wl_compositor_destroy(wm->wayland_ctx->wl_compositor);
@@ -1276,6 +1846,8 @@ static void _cleanup_wl(glps_WindowManager *wm)
     }
     if (wm->wayland_ctx->wl_display != NULL)
     {
+      if (wm->wayland_ctx->read_prepared)
+        wl_display_cancel_read(wm->wayland_ctx->wl_display);
       wl_display_disconnect(wm->wayland_ctx->wl_display);
       wm->wayland_ctx->wl_display = NULL;
     }
@@ -1286,6 +1858,13 @@ static void _cleanup_wl(glps_WindowManager *wm)
 
 ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
                               int x, int y, int width, int height)
+{
+  return glps_wl_window_create_ex(wm, title, x, y, width, height, NULL);
+}
+
+ssize_t glps_wl_window_create_ex(glps_WindowManager *wm, const char *title,
+                                 int x, int y, int width, int height,
+                                 const glps_SurfaceConfig *config)
 {
   (void)x;
   (void)y;
@@ -1297,12 +1876,10 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
     return -1;
   }
 
-  if (wm->window_count >= (size_t)MAX_WINDOWS)
-  {
-    LOG_ERROR("glps_wl_window_create: maximum number of windows (%d) reached",
-              MAX_WINDOWS);
+  // Chosen before the first window creates the context, which may need it.
+  EGLConfig egl_config = EGL_NO_CONFIG_KHR;
+  if (wm->egl_ctx != NULL && (egl_config = glps_egl_choose_config(wm, config)) == EGL_NO_CONFIG_KHR)
     return -1;
-  }
 
   glps_WaylandWindow *window = malloc(sizeof(glps_WaylandWindow));
   if (window == NULL)
@@ -1312,28 +1889,53 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
   }
   memset(window, 0, sizeof(glps_WaylandWindow));
   window->egl_surface = EGL_NO_SURFACE;
+  glps_scheduler_init(&window->schedule);
+  window->present = (glps_PresentState){.swap_interval = 1};
+
+  if (wm->wayland_ctx->window_queues)
+  {
+    window->queue = wl_display_create_queue(wm->wayland_ctx->wl_display);
+    if (window->queue == NULL)
+    {
+      LOG_ERROR("Failed to create window event queue");
+      free(window);
+      return -1;
+    }
+  }
 
   window->wl_surface =
       wl_compositor_create_surface(wm->wayland_ctx->wl_compositor);
+  if (window->wl_surface != NULL && window->queue != NULL)
+    wl_proxy_set_queue((struct wl_proxy *)window->wl_surface, window->queue);
+  if (window->wl_surface != NULL)
+    wl_surface_add_listener(window->wl_surface, &wl_surface_listener, wm);
   if (!window->wl_surface)
   {
     LOG_ERROR("Failed to create wayland surface");
+    if (window->queue != NULL)
+      wl_event_queue_destroy(window->queue);
     free(window);
     return -1;
   }
 
   window->properties.width  = width;
   window->properties.height = height;
+  window->resize            = (glps_ResizeState){.width = width, .height = height};
   strncpy(window->properties.title, title,
           sizeof(window->properties.title) - 1);
   window->properties.title[sizeof(window->properties.title) - 1] = '\0';
 
   window->xdg_surface = xdg_wm_base_get_xdg_surface(
       wm->wayland_ctx->xdg_wm_base, window->wl_surface);
+  // The toplevel and frame callbacks inherit the queue of their factory.
+  if (window->xdg_surface != NULL && window->queue != NULL)
+    wl_proxy_set_queue((struct wl_proxy *)window->xdg_surface, window->queue);
   if (!window->xdg_surface)
   {
     LOG_ERROR("Failed to create XDG surface");
     wl_surface_destroy(window->wl_surface);
+    if (window->queue != NULL)
+      wl_event_queue_destroy(window->queue);
     free(window);
     return -1;
   }
@@ -1344,6 +1946,8 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
     LOG_ERROR("Failed to add XDG surface listener");
     xdg_surface_destroy(window->xdg_surface);
     wl_surface_destroy(window->wl_surface);
+    if (window->queue != NULL)
+      wl_event_queue_destroy(window->queue);
     free(window);
     return -1;
   }
@@ -1354,6 +1958,8 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
     LOG_ERROR("Failed to create toplevel");
     xdg_surface_destroy(window->xdg_surface);
     wl_surface_destroy(window->wl_surface);
+    if (window->queue != NULL)
+      wl_event_queue_destroy(window->queue);
     free(window);
     return -1;
   }
@@ -1362,9 +1968,12 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
   xdg_toplevel_add_listener(window->xdg_toplevel, &toplevel_listener, wm);
 
   wl_surface_commit(window->wl_surface);
-  LOG_INFO("Committing surface for window id %zu", wm->window_count);
-  wl_display_roundtrip(wm->wayland_ctx->wl_display);
-  LOG_INFO("Surface committed for window id %zu", wm->window_count);
+  LOG_INFO("Committing surface for window \"%s\"", window->properties.title);
+  if (window->queue != NULL)
+    wl_display_roundtrip_queue(wm->wayland_ctx->wl_display, window->queue);
+  else
+    wl_display_roundtrip(wm->wayland_ctx->wl_display);
+  LOG_INFO("Surface committed for window \"%s\"", window->properties.title);
 
   if (wm->window_count == 0)
   {
@@ -1377,6 +1986,8 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
     xdg_toplevel_destroy(window->xdg_toplevel);
     xdg_surface_destroy(window->xdg_surface);
     wl_surface_destroy(window->wl_surface);
+    if (window->queue != NULL)
+      wl_event_queue_destroy(window->queue);
     free(window);
     return -1;
   }
@@ -1389,13 +2000,14 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
     xdg_toplevel_destroy(window->xdg_toplevel);
     xdg_surface_destroy(window->xdg_surface);
     wl_surface_destroy(window->wl_surface);
+    if (window->queue != NULL)
+      wl_event_queue_destroy(window->queue);
     free(window);
     return -1;
   }
 
-  window->egl_surface =
-      eglCreateWindowSurface(wm->egl_ctx->dpy, wm->egl_ctx->conf,
-                             (NativeWindowType)window->egl_window, NULL);
+  window->egl_surface = glps_egl_create_surface(wm, egl_config, config,
+                                                (EGLNativeWindowType)window->egl_window);
   if (window->egl_surface == EGL_NO_SURFACE)
   {
     LOG_ERROR("Failed to create EGL surface (eglGetError: 0x%x)", eglGetError());
@@ -1403,12 +2015,47 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
     xdg_toplevel_destroy(window->xdg_toplevel);
     xdg_surface_destroy(window->xdg_surface);
     wl_surface_destroy(window->wl_surface);
+    if (window->queue != NULL)
+      wl_event_queue_destroy(window->queue);
     free(window);
     return -1;
   }
 
-  size_t new_window_id   = wm->window_count;
-  wm->windows[new_window_id] = window;
+  ssize_t inserted_id = glps_window_table_insert(wm, window);
+  if (inserted_id < 0)
+  {
+    LOG_ERROR("Failed to register Wayland window");
+    eglDestroySurface(wm->egl_ctx->dpy, window->egl_surface);
+    wl_egl_window_destroy(window->egl_window);
+    xdg_toplevel_destroy(window->xdg_toplevel);
+    xdg_surface_destroy(window->xdg_surface);
+    wl_surface_destroy(window->wl_surface);
+    if (window->queue != NULL)
+      wl_event_queue_destroy(window->queue);
+    free(window);
+    return -1;
+  }
+  size_t new_window_id = (size_t)inserted_id;
+
+  if (!glps_window_index_add(wm, (uintptr_t)window->wl_surface, new_window_id) ||
+      !glps_window_index_add(wm, (uintptr_t)window->xdg_surface, new_window_id) ||
+      !glps_window_index_add(wm, (uintptr_t)window->xdg_toplevel, new_window_id))
+  {
+    LOG_ERROR("Failed to index Wayland window id %zu", new_window_id);
+    glps_window_index_remove(wm, (uintptr_t)window->wl_surface);
+    glps_window_index_remove(wm, (uintptr_t)window->xdg_surface);
+    glps_window_index_remove(wm, (uintptr_t)window->xdg_toplevel);
+    eglDestroySurface(wm->egl_ctx->dpy, window->egl_surface);
+    wl_egl_window_destroy(window->egl_window);
+    xdg_toplevel_destroy(window->xdg_toplevel);
+    xdg_surface_destroy(window->xdg_surface);
+    wl_surface_destroy(window->wl_surface);
+    glps_window_table_remove(wm, new_window_id);
+    if (window->queue != NULL)
+      wl_event_queue_destroy(window->queue);
+    free(window);
+    return -1;
+  }
 
   glps_egl_make_ctx_current(wm, new_window_id);
 
@@ -1416,12 +2063,18 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
   if (frame_args == NULL)
   {
     LOG_ERROR("Failed to allocate frame_callback_args");
+    glps_window_index_remove(wm, (uintptr_t)window->wl_surface);
+    glps_window_index_remove(wm, (uintptr_t)window->xdg_surface);
+    glps_window_index_remove(wm, (uintptr_t)window->xdg_toplevel);
+    glps_egl_release_surface(wm, window->egl_surface);
     eglDestroySurface(wm->egl_ctx->dpy, window->egl_surface);
     wl_egl_window_destroy(window->egl_window);
     xdg_toplevel_destroy(window->xdg_toplevel);
     xdg_surface_destroy(window->xdg_surface);
     wl_surface_destroy(window->wl_surface);
-    wm->windows[new_window_id] = NULL;
+    glps_window_table_remove(wm, new_window_id);
+    if (window->queue != NULL)
+      wl_event_queue_destroy(window->queue);
     free(window);
     return -1;
   }
@@ -1437,7 +2090,6 @@ ssize_t glps_wl_window_create(glps_WindowManager *wm, const char *title,
               new_window_id, eglGetError());
   }
 
-  wm->window_count = new_window_id + 1;
   return (ssize_t)new_window_id;
 }
 
@@ -1450,7 +2102,7 @@ void glps_wl_window_is_resizable(glps_WindowManager *wm, bool state,
     return;
   }
 
-  glps_WaylandWindow *window = wm->windows[window_id];
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
 
   int window_width  = window->properties.width;
   int window_height = window->properties.height;
@@ -1463,6 +2115,119 @@ void glps_wl_window_is_resizable(glps_WindowManager *wm, bool state,
 }
 
 bool glps_wl_should_close(glps_WindowManager *wm)
+{
+  // Never blocks: a window with no input or frame callbacks pending must not
+  // stall the render loop, so only what is already readable is consumed.
+  return glps_wl_wait_events(wm, 0);
+}
+
+static void __drain_input_thread(glps_WindowManager *wm)
+{
+  glps_Event event;
+  while (glps_input_thread_pop(wm, &event))
+    glps_events_emit(wm, &event);
+}
+
+bool glps_wl_prepare(glps_WindowManager *wm)
+{
+  if (wm == NULL || wm->wayland_ctx == NULL || wm->wayland_ctx->wl_display == NULL)
+    return false;
+
+  if (glps_input_thread_pending(wm) > 0)
+    return false;
+
+  if (wm->wayland_ctx->read_prepared)
+    return true;
+
+  struct wl_display *display = wm->wayland_ctx->wl_display;
+
+  // prepare_read fails while events are still queued; those have to be
+  // dispatched first, otherwise they would wait for the next socket read.
+  while (wl_display_prepare_read(display) != 0)
+  {
+    if (wl_display_dispatch_pending(display) < 0)
+    {
+      LOG_ERROR("Wayland display error: %d", wl_display_get_error(display));
+      wm->should_close = true;
+      return false;
+    }
+  }
+
+  if (wl_display_flush(display) < 0 && errno != EAGAIN)
+  {
+    wl_display_cancel_read(display);
+    LOG_ERROR("Wayland display error: %d", wl_display_get_error(display));
+    wm->should_close = true;
+    return false;
+  }
+
+  wm->wayland_ctx->read_prepared = true;
+  return true;
+}
+
+bool glps_wl_dispatch_pending(glps_WindowManager *wm)
+{
+  if (wm == NULL || wm->wayland_ctx == NULL || wm->wayland_ctx->wl_display == NULL)
+    return true;
+
+  struct wl_display *display = wm->wayland_ctx->wl_display;
+
+  glps_wakeup_drain(wm);
+
+  if (wm->wayland_ctx->read_prepared)
+  {
+    wm->wayland_ctx->read_prepared = false;
+
+    // While the input thread or a window thread holds its own read intent,
+    // wl_display_read_events blocks until the socket is readable, so only
+    // read when it already is and give the intent back otherwise.
+    struct pollfd fd = {.fd = wl_display_get_fd(display), .events = POLLIN};
+    int ready = poll(&fd, 1, 0);
+    if (ready > 0 && (fd.revents & (POLLERR | POLLHUP)))
+    {
+      wl_display_cancel_read(display);
+      LOG_ERROR("Wayland display connection lost.");
+      wm->should_close = true;
+      return true;
+    }
+
+    if (ready > 0 && (fd.revents & POLLIN))
+    {
+      if (wl_display_read_events(display) < 0)
+      {
+        LOG_ERROR("Wayland display error: %d", wl_display_get_error(display));
+        return true;
+      }
+    }
+    else
+    {
+      wl_display_cancel_read(display);
+    }
+  }
+
+  __drain_input_thread(wm);
+
+  if (wl_display_dispatch_pending(display) < 0)
+  {
+    LOG_ERROR("Wayland display error: %d", wl_display_get_error(display));
+    return true;
+  }
+
+  __apply_resizes(wm, NULL);
+  __run_scheduled_frames(wm, NULL);
+
+  return wm->should_close;
+}
+
+int64_t glps_wl_next_timeout_ns(glps_WindowManager *wm)
+{
+  if (wm == NULL || wm->wayland_ctx == NULL)
+    return -1;
+
+  return __scheduled_timeout_ns(wm, NULL, -1);
+}
+
+bool glps_wl_wait_events(glps_WindowManager *wm, int64_t timeout_ns)
 {
   if (wm == NULL || wm->wayland_ctx == NULL || wm->wayland_ctx->wl_display == NULL)
     return true;
@@ -1470,16 +2235,231 @@ bool glps_wl_should_close(glps_WindowManager *wm)
   if (wm->should_close)
     return true;
 
-  int ret = wl_display_dispatch(wm->wayland_ctx->wl_display);
-  if (ret == -1)
+  if (glps_wl_prepare(wm))
   {
-    int err = wl_display_get_error(wm->wayland_ctx->wl_display);
-    if (err != 0)
-      LOG_ERROR("Wayland display error: %d", err);
+    struct wl_display *display = wm->wayland_ctx->wl_display;
+    struct pollfd fds[2] = {
+        {.fd = wl_display_get_fd(display), .events = POLLIN},
+        {.fd = wm->wakeup_fd, .events = POLLIN},
+    };
+
+    timeout_ns = __scheduled_timeout_ns(wm, NULL, timeout_ns);
+    int ready = poll(fds, wm->wakeup_fd >= 0 ? 2 : 1, glps_wakeup_timeout_ms(timeout_ns));
+    if (ready < 0 && errno != EINTR)
+      LOG_ERROR("poll on Wayland display failed: %s", strerror(errno));
+
+    if (ready > 0 && (fds[0].revents & (POLLERR | POLLHUP)))
+    {
+      wl_display_cancel_read(display);
+      wm->wayland_ctx->read_prepared = false;
+      LOG_ERROR("Wayland display connection lost.");
+      wm->should_close = true;
+      return true;
+    }
+
+    // Give the read intent back when the socket has nothing, so threads
+    // reading their own queues are not held up waiting for this one.
+    if (ready <= 0 || !(fds[0].revents & POLLIN))
+    {
+      wl_display_cancel_read(display);
+      wm->wayland_ctx->read_prepared = false;
+    }
+  }
+
+  return glps_wl_dispatch_pending(wm);
+}
+
+void glps_wl_enable_window_queues(glps_WindowManager *wm, bool enable)
+{
+  if (wm == NULL || wm->wayland_ctx == NULL)
+    return;
+
+  wm->wayland_ctx->window_queues = enable;
+}
+
+bool glps_wl_window_dispatch(glps_WindowManager *wm, size_t window_id, int64_t timeout_ns)
+{
+  if (!__is_valid_window_id(wm, window_id))
+  {
+    LOG_ERROR("glps_wl_window_dispatch: invalid window id %zu", window_id);
     return true;
   }
 
-  return false;
+  struct wl_event_queue *queue = wm->windows[GLPS_WINDOW_SLOT(window_id)]->queue;
+  if (queue == NULL)
+    return glps_wl_wait_events(wm, timeout_ns);
+
+  struct wl_display *display = wm->wayland_ctx->wl_display;
+
+  while (wl_display_prepare_read_queue(display, queue) != 0)
+  {
+    if (wl_display_dispatch_queue_pending(display, queue) < 0)
+      goto display_error;
+  }
+
+  if (wl_display_flush(display) < 0 && errno != EAGAIN)
+  {
+    wl_display_cancel_read(display);
+    goto display_error;
+  }
+
+  struct pollfd fd = {.fd = wl_display_get_fd(display), .events = POLLIN};
+  int ready = poll(&fd, 1, glps_wakeup_timeout_ms(__scheduled_timeout_ns(wm, queue, timeout_ns)));
+  if (ready < 0 && errno != EINTR)
+    LOG_ERROR("poll on Wayland display failed: %s", strerror(errno));
+
+  if (ready > 0 && (fd.revents & POLLIN))
+  {
+    // Events for other queues are routed to them and wake their readers.
+    if (wl_display_read_events(display) < 0)
+      goto display_error;
+  }
+  else
+  {
+    wl_display_cancel_read(display);
+  }
+
+  if (wl_display_dispatch_queue_pending(display, queue) < 0)
+    goto display_error;
+
+  __apply_pending_refresh(wm, wm->windows[GLPS_WINDOW_SLOT(window_id)]);
+  __apply_resizes(wm, queue);
+  __run_scheduled_frames(wm, queue);
+
+  return wm->should_close;
+
+display_error:
+  LOG_ERROR("Wayland display error: %d", wl_display_get_error(display));
+  return true;
+}
+
+static void __set_seat_queue(glps_WaylandContext *ctx, struct wl_event_queue *queue)
+{
+  if (ctx->wl_seat != NULL)
+    wl_proxy_set_queue((struct wl_proxy *)ctx->wl_seat, queue);
+  if (ctx->wl_pointer != NULL)
+    wl_proxy_set_queue((struct wl_proxy *)ctx->wl_pointer, queue);
+  if (ctx->wl_keyboard != NULL)
+    wl_proxy_set_queue((struct wl_proxy *)ctx->wl_keyboard, queue);
+  if (ctx->wl_touch != NULL)
+    wl_proxy_set_queue((struct wl_proxy *)ctx->wl_touch, queue);
+}
+
+bool glps_wl_input_thread_setup(glps_WindowManager *wm)
+{
+  struct glps_InputThread *input = wm->input_thread;
+
+  input->stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  atomic_init(&input->seat_dirty, false);
+  if (input->stop_fd < 0)
+  {
+    LOG_ERROR("Failed to create input thread eventfd: %s", strerror(errno));
+    return false;
+  }
+
+  input->queue = wl_display_create_queue(wm->wayland_ctx->wl_display);
+  if (input->queue == NULL)
+  {
+    LOG_ERROR("Failed to create input event queue");
+    close(input->stop_fd);
+    return false;
+  }
+
+  // Objects created from the seat later inherit its queue, so capability
+  // changes and new pointer/keyboard/touch objects stay on the input thread.
+  __set_seat_queue(wm->wayland_ctx, input->queue);
+  return true;
+}
+
+void *glps_wl_input_thread_run(void *arg)
+{
+  glps_WindowManager      *wm      = (glps_WindowManager *)arg;
+  struct glps_InputThread *input   = wm->input_thread;
+  struct wl_display       *display = wm->wayland_ctx->wl_display;
+
+  glps_input_thread_enter(wm);
+
+  while (atomic_load(&input->running))
+  {
+    if (atomic_exchange(&input->seat_dirty, false))
+      __apply_seat_capabilities(wm);
+
+    while (wl_display_prepare_read_queue(display, input->queue) != 0)
+    {
+      if (wl_display_dispatch_queue_pending(display, input->queue) < 0)
+        goto display_error;
+    }
+
+    wl_display_flush(display);
+
+    struct pollfd fds[2] = {
+        {.fd = wl_display_get_fd(display), .events = POLLIN},
+        {.fd = input->stop_fd, .events = POLLIN},
+    };
+
+    if (poll(fds, 2, -1) < 0 && errno != EINTR)
+    {
+      wl_display_cancel_read(display);
+      LOG_ERROR("poll on Wayland display failed: %s", strerror(errno));
+      break;
+    }
+
+    if (fds[0].revents & POLLIN)
+    {
+      if (wl_display_read_events(display) < 0)
+        goto display_error;
+    }
+    else
+    {
+      wl_display_cancel_read(display);
+    }
+
+    if (fds[1].revents & POLLIN)
+    {
+      uint64_t value;
+      while (read(input->stop_fd, &value, sizeof(value)) < 0 && errno == EINTR)
+        ;
+    }
+
+    int dispatched = wl_display_dispatch_queue_pending(display, input->queue);
+    if (dispatched < 0)
+      goto display_error;
+    if (dispatched > 0)
+      glps_wakeup_post(wm);
+  }
+
+  return NULL;
+
+display_error:
+  LOG_ERROR("Wayland display error on input thread: %d", wl_display_get_error(display));
+  glps_wakeup_post(wm);
+  return NULL;
+}
+
+void glps_wl_input_thread_wake(glps_WindowManager *wm)
+{
+  uint64_t value = 1;
+  while (write(wm->input_thread->stop_fd, &value, sizeof(value)) < 0 && errno == EINTR)
+    ;
+}
+
+void glps_wl_input_thread_teardown(glps_WindowManager *wm)
+{
+  struct glps_InputThread *input = wm->input_thread;
+
+  // Deliver what the thread already decoded, then anything it had not yet
+  // dispatched, in order, before moving the seat back to the default queue.
+  __drain_input_thread(wm);
+
+  wl_display_dispatch_queue_pending(wm->wayland_ctx->wl_display, input->queue);
+  __set_seat_queue(wm->wayland_ctx, NULL);
+  if (atomic_exchange(&input->seat_dirty, false))
+    __apply_seat_capabilities(wm);
+
+  wl_event_queue_destroy(input->queue);
+  input->queue = NULL;
+  close(input->stop_fd);
+  input->stop_fd = -1;
 }
 
 void glps_wl_destroy(glps_WindowManager *wm)
@@ -1500,25 +2480,21 @@ bool glps_wl_init(glps_WindowManager *wm)
   if (wm == NULL)
     return false;
 
-  wm->windows = malloc(sizeof(glps_WaylandWindow *) * MAX_WINDOWS);
-  if (!wm->windows)
+  if (!glps_window_table_init(wm))
   {
     LOG_ERROR("Failed to allocate memory for windows array");
     return false;
   }
-  memset(wm->windows, 0, sizeof(glps_WaylandWindow *) * MAX_WINDOWS);
 
   wm->wayland_ctx = malloc(sizeof(glps_WaylandContext));
   if (!wm->wayland_ctx)
   {
     LOG_ERROR("Failed to allocate memory for Wayland context");
-    free(wm->windows);
-    wm->windows = NULL;
+    glps_window_table_destroy(wm);
     return false;
   }
-  *wm->wayland_ctx = (glps_WaylandContext){0};
+  *wm->wayland_ctx = (glps_WaylandContext){.presentation_clock = CLOCK_MONOTONIC};
 
-  wm->window_count             = 0;
   wm->wayland_ctx->wl_touch    = NULL;
   wm->wayland_ctx->wl_pointer  = NULL;
   wm->wayland_ctx->wl_keyboard = NULL;
@@ -1530,8 +2506,7 @@ bool glps_wl_init(glps_WindowManager *wm)
     LOG_ERROR("Failed to create xkb context");
     free(wm->wayland_ctx);
     wm->wayland_ctx = NULL;
-    free(wm->windows);
-    wm->windows = NULL;
+    glps_window_table_destroy(wm);
     return false;
   }
 
@@ -1542,8 +2517,7 @@ bool glps_wl_init(glps_WindowManager *wm)
     xkb_context_unref(wm->wayland_ctx->xkb_context);
     free(wm->wayland_ctx);
     wm->wayland_ctx = NULL;
-    free(wm->windows);
-    wm->windows = NULL;
+    glps_window_table_destroy(wm);
     return false;
   }
 
@@ -1556,8 +2530,7 @@ bool glps_wl_init(glps_WindowManager *wm)
     xkb_context_unref(wm->wayland_ctx->xkb_context);
     free(wm->wayland_ctx);
     wm->wayland_ctx = NULL;
-    free(wm->windows);
-    wm->windows = NULL;
+    glps_window_table_destroy(wm);
     return false;
   }
 
@@ -1570,8 +2543,7 @@ bool glps_wl_init(glps_WindowManager *wm)
     xkb_context_unref(wm->wayland_ctx->xkb_context);
     free(wm->wayland_ctx);
     wm->wayland_ctx = NULL;
-    free(wm->windows);
-    wm->windows = NULL;
+    glps_window_table_destroy(wm);
     return false;
   }
 
@@ -1605,8 +2577,7 @@ bool glps_wl_init(glps_WindowManager *wm)
     xkb_context_unref(wm->wayland_ctx->xkb_context);
     free(wm->wayland_ctx);
     wm->wayland_ctx = NULL;
-    free(wm->windows);
-    wm->windows = NULL;
+    glps_window_table_destroy(wm);
     return false;
   }
 
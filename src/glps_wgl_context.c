@@ -11,4 +11,16 @@ void *glps_wgl_get_proc_addr(const char *name) {
 void glps_wgl_swap_buffers(glps_WindowManager *wm, size_t window_id) {
   SwapBuffers(wm->windows[window_id]->hdc);
 }
+void glps_wgl_swap_interval(glps_WindowManager *wm, int interval) {
+  (void)wm;
+  // WGL_EXT_swap_control applies to the current context's drawable.
+  BOOL (WINAPI *swap_interval)(int) =
+      (BOOL (WINAPI *)(int))glps_wgl_get_proc_addr("wglSwapIntervalEXT");
+  if (swap_interval == NULL) {
+    LOG_WARNING("wglSwapIntervalEXT is not available.");
+    return;
+  }
+  if (!swap_interval(interval))
+    LOG_ERROR("wglSwapIntervalEXT(%d) failed", interval);
+}
 void glps_wgl_destroy(glps_WindowManager *wm);
@@ -0,0 +1,97 @@
+#include "glps_window_index.h"
+#include "glps_input_thread.h"
+#include "utils/logger/pico_logger.h"
+#include "utils/uthash/uthash.h"
+
+struct glps_WindowIndexEntry
+{
+    uintptr_t key;
+    size_t window_id;
+    UT_hash_handle hh;
+};
+
+bool glps_window_index_add(glps_WindowManager *wm, uintptr_t key, size_t window_id)
+{
+    if (wm == NULL || key == 0) return false;
+
+    bool added = true;
+    glps_input_thread_lock(wm);
+
+    struct glps_WindowIndexEntry *entry = NULL;
+    HASH_FIND(hh, wm->window_index, &key, sizeof(key), entry);
+    if (entry != NULL)
+    {
+        entry->window_id = window_id;
+    }
+    else if ((entry = (struct glps_WindowIndexEntry *)malloc(sizeof(*entry))) != NULL)
+    {
+        entry->key = key;
+        entry->window_id = window_id;
+        HASH_ADD(hh, wm->window_index, key, sizeof(entry->key), entry);
+    }
+    else
+    {
+        LOG_ERROR("Failed to allocate window index entry");
+        added = false;
+    }
+
+    glps_input_thread_unlock(wm);
+    return added;
+}
+
+ssize_t glps_window_index_find(glps_WindowManager *wm, uintptr_t key)
+{
+    if (wm == NULL) return -1;
+
+    glps_input_thread_lock(wm);
+
+    struct glps_WindowIndexEntry *entry = NULL;
+    HASH_FIND(hh, wm->window_index, &key, sizeof(key), entry);
+    ssize_t window_id = entry != NULL ? (ssize_t)entry->window_id : -1;
+
+    glps_input_thread_unlock(wm);
+    return window_id;
+}
+
+void glps_window_index_update(glps_WindowManager *wm, uintptr_t key, size_t window_id)
+{
+    if (wm == NULL) return;
+
+    glps_input_thread_lock(wm);
+
+    struct glps_WindowIndexEntry *entry = NULL;
+    HASH_FIND(hh, wm->window_index, &key, sizeof(key), entry);
+    if (entry != NULL) entry->window_id = window_id;
+
+    glps_input_thread_unlock(wm);
+}
+
+void glps_window_index_remove(glps_WindowManager *wm, uintptr_t key)
+{
+    if (wm == NULL) return;
+
+    glps_input_thread_lock(wm);
+
+    struct glps_WindowIndexEntry *entry = NULL;
+    HASH_FIND(hh, wm->window_index, &key, sizeof(key), entry);
+    if (entry != NULL)
+    {
+        HASH_DEL(wm->window_index, entry);
+        free(entry);
+    }
+
+    glps_input_thread_unlock(wm);
+}
+
+void glps_window_index_clear(glps_WindowManager *wm)
+{
+    if (wm == NULL) return;
+
+    struct glps_WindowIndexEntry *entry, *tmp;
+    HASH_ITER(hh, wm->window_index, entry, tmp)
+    {
+        HASH_DEL(wm->window_index, entry);
+        free(entry);
+    }
+    wm->window_index = NULL;
+}
@@ -1,4 +1,12 @@
 #include "glps_window_manager.h"
+#include "glps_window_table.h"
+#include "glps_wakeup.h"
+#include "glps_events.h"
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+#include "glps_input_thread.h"
+#include "glps_latency.h"
+#include "glps_scheduler.h"
+#endif
 #include "utils/logger/pico_logger.h"
 
 #include <stddef.h>
@@ -27,6 +35,67 @@
 #include <glps_egl_context.h>
 #endif
 
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+#include "glps_capture.h"
+#include "glps_headless.h"
+#endif
+
+static bool __is_valid_window(glps_WindowManager *wm, size_t window_id)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  return glps_window_table_is_live(wm, window_id);
+#else
+  return wm != NULL && window_id < wm->window_count &&
+         wm->windows[window_id] != NULL;
+#endif
+}
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+// Sleeps in the event wait while an on-demand or hidden window has nothing
+// to render. Returns true if the window has a frame to render after all.
+static bool __wait_for_redraw(glps_WindowManager *wm, size_t window_id)
+{
+  uint64_t now = glps_latency_now_ns();
+  glps_FrameSchedule *schedule = &wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule;
+  if (glps_scheduler_wants_frame(schedule, now))
+    return true;
+
+  // Windows with a frame to render keep the wait from blocking their updates.
+  int64_t timeout_ns = -1;
+  for (size_t slot = 0; slot < glps_window_table_capacity(wm) && timeout_ns != 0; ++slot)
+  {
+    if (glps_window_table_id_at(wm, slot) < 0)
+      continue;
+
+    uint64_t at = glps_scheduler_next_frame_at(&wm->windows[slot]->schedule, now);
+    if (at == 0)
+      continue;
+
+    int64_t remaining = at > now ? (int64_t)(at - now) : 0;
+    if (timeout_ns < 0 || remaining < timeout_ns)
+      timeout_ns = remaining;
+  }
+
+  schedule->stats.idle_waits++;
+  glps_wm_wait_events(wm, timeout_ns);
+
+  return __is_valid_window(wm, window_id) &&
+         glps_scheduler_wants_frame(&wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule,
+                                    glps_latency_now_ns());
+}
+#endif
+
+// Subscribes the backend to exactly the input the callbacks observe.
+static void __update_input_interest(glps_WindowManager *wm)
+{
+#ifdef GLPS_USE_X11
+  glps_x11_update_input_mask(wm);
+#endif
+#ifdef GLPS_USE_WAYLAND
+  glps_wl_update_seat_capabilities(wm);
+#endif
+}
+
 void glps_wm_set_mouse_enter_callback(
     glps_WindowManager *wm,
     void (*mouse_enter_callback)(size_t window_id, double mouse_x,
@@ -42,6 +111,7 @@ void glps_wm_set_mouse_enter_callback(
 
   wm->callbacks.mouse_enter_callback = mouse_enter_callback;
   wm->callbacks.mouse_move_data = data;
+  __update_input_interest(wm);
 }
 
 void glps_wm_set_mouse_leave_callback(
@@ -57,6 +127,7 @@ void glps_wm_set_mouse_leave_callback(
 
   wm->callbacks.mouse_leave_callback = mouse_leave_callback;
   wm->callbacks.mouse_leave_data = data;
+  __update_input_interest(wm);
 }
 
 void glps_wm_set_mouse_move_callback(
@@ -74,6 +145,7 @@ void glps_wm_set_mouse_move_callback(
 
   wm->callbacks.mouse_move_callback = mouse_move_callback;
   wm->callbacks.mouse_move_data = data;
+  __update_input_interest(wm);
 }
 
 void glps_wm_set_mouse_click_callback(
@@ -90,6 +162,7 @@ void glps_wm_set_mouse_click_callback(
 
   wm->callbacks.mouse_click_callback = mouse_click_callback;
   wm->callbacks.mouse_click_data = data;
+  __update_input_interest(wm);
 }
 
 void glps_wm_set_scroll_callback(
@@ -108,6 +181,7 @@ void glps_wm_set_scroll_callback(
 
   wm->callbacks.mouse_scroll_callback = mouse_scroll_callback;
   wm->callbacks.mouse_scroll_data = data;
+  __update_input_interest(wm);
 }
 
 void glps_wm_set_keyboard_enter_callback(
@@ -123,6 +197,7 @@ void glps_wm_set_keyboard_enter_callback(
 
   wm->callbacks.keyboard_enter_callback = keyboard_enter_callback;
   wm->callbacks.keyboard_enter_data = data;
+  __update_input_interest(wm);
 }
 
 void glps_wm_set_keyboard_callback(glps_WindowManager *wm,
@@ -142,6 +217,7 @@ void glps_wm_set_keyboard_callback(glps_WindowManager *wm,
 
   wm->callbacks.keyboard_callback = keyboard_callback;
   wm->callbacks.keyboard_data = data;
+  __update_input_interest(wm);
 }
 
 void glps_wm_set_keyboard_leave_callback(
@@ -157,6 +233,7 @@ void glps_wm_set_keyboard_leave_callback(
 
   wm->callbacks.keyboard_leave_callback = keyboard_leave_callback;
   wm->callbacks.keyboard_leave_data = data;
+  __update_input_interest(wm);
 }
 
 
@@ -177,6 +254,7 @@ void glps_wm_set_touch_callback(
 
   wm->callbacks.touch_callback = touch_callback;
   wm->callbacks.touch_data = data;
+  __update_input_interest(wm);
 }
 
 void glps_wm_attach_to_clipboard(glps_WindowManager *wm, char *mime,
@@ -280,23 +358,153 @@ void glps_wm_start_drag_n_drop(
 }
 
 void glps_wm_swap_interval(glps_WindowManager *wm, unsigned int swap_interval)
+{
+  if (wm == NULL)
+    return;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
+  {
+    ssize_t window_id = glps_window_table_id_at(wm, slot);
+    if (window_id < 0)
+      continue;
+
+    if (swap_interval > 0)
+      wm->windows[slot]->present.swap_interval = (int)swap_interval;
+    glps_wm_window_set_present_mode(wm, (size_t)window_id,
+                                    swap_interval == 0 ? GLPS_PRESENT_MODE_IMMEDIATE
+                                                       : GLPS_PRESENT_MODE_FIFO);
+  }
+#endif
+
+#ifdef GLPS_USE_WIN32
+  glps_wgl_swap_interval(wm, (int)swap_interval);
+#endif
+}
+
+void glps_wm_window_set_present_mode(glps_WindowManager *wm, size_t window_id,
+                                     GLPS_PRESENT_MODE mode)
+{
+  if (!__is_valid_window(wm, window_id))
+    return;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_PresentState *present = &wm->windows[GLPS_WINDOW_SLOT(window_id)]->present;
+  present->mode = mode;
+  present->applied = false;
+#ifdef GLPS_USE_WAYLAND
+  if (!wm->headless)
+    glps_wl_window_set_present_mode(wm, window_id);
+#endif
+  // Takes effect now if the surface is current, otherwise when it becomes current.
+  glps_egl_apply_present_mode(wm, window_id);
+#else
+  if (mode != GLPS_PRESENT_MODE_FIFO)
+    LOG_WARNING("Present modes are not supported on this platform.");
+#endif
+}
+
+GLPS_PRESENT_MODE glps_wm_window_get_present_mode(glps_WindowManager *wm, size_t window_id)
 {
 #if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
-  eglSwapInterval(wm->egl_ctx->dpy, 0);
+  if (__is_valid_window(wm, window_id))
+    return wm->windows[GLPS_WINDOW_SLOT(window_id)]->present.mode;
 #endif
+  return GLPS_PRESENT_MODE_FIFO;
 }
 
 void glps_wm_swap_buffers(glps_WindowManager *wm, size_t window_id)
 {
+  glps_wm_swap_buffers_with_damage(wm, window_id, NULL, 0);
+}
+
+void glps_wm_swap_buffers_with_damage(glps_WindowManager *wm, size_t window_id,
+                                      const glps_Rect *rects, size_t count)
+{
+#ifdef GLPS_USE_WAYLAND
+  if (!wm->headless)
+    glps_wl_prepare_commit(wm, window_id);
+#endif
+
 #if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
-  glps_egl_swap_buffers(wm, window_id);
+  // Blocking in the swap is waiting for the display, not rendering.
+  if (__is_valid_window(wm, window_id))
+  {
+    glps_capture_frame(wm, window_id);
+    glps_scheduler_end_render(&wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule);
+    glps_egl_apply_present_mode(wm, window_id);
+  }
+  glps_egl_swap_buffers_with_damage(wm, window_id, rects, count);
+  glps_latency_record_swap(wm, window_id);
+#endif
+
+#ifdef GLPS_USE_X11
+  glps_x11_after_swap(wm, window_id);
 #endif
 
 #ifdef GLPS_USE_WIN32
+  (void)rects;
+  (void)count;
   glps_wgl_swap_buffers(wm, window_id);
 #endif
 }
 
+bool glps_wm_capture_start(glps_WindowManager *wm, size_t window_id, const glps_CaptureSink *sink)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (!__is_valid_window(wm, window_id))
+  {
+    LOG_ERROR("Invalid window ID.");
+    return false;
+  }
+  return glps_capture_start(wm, window_id, sink);
+#else
+  (void)window_id;
+  (void)sink;
+  LOG_WARNING("Frame capture is not supported on this platform.");
+  return false;
+#endif
+}
+
+void glps_wm_capture_stop(glps_WindowManager *wm, size_t window_id, glps_CaptureStats *stats)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (stats != NULL)
+    *stats = (glps_CaptureStats){0};
+  if (__is_valid_window(wm, window_id))
+    glps_capture_stop(wm, window_id, stats);
+#else
+  (void)wm;
+  (void)window_id;
+  if (stats != NULL)
+    *stats = (glps_CaptureStats){0};
+#endif
+}
+
+bool glps_wm_capture_get_stats(glps_WindowManager *wm, size_t window_id, glps_CaptureStats *stats)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  return __is_valid_window(wm, window_id) && glps_capture_get_stats(wm, window_id, stats);
+#else
+  (void)wm;
+  (void)window_id;
+  (void)stats;
+  return false;
+#endif
+}
+
+int glps_wm_get_buffer_age(glps_WindowManager *wm, size_t window_id)
+{
+  if (!__is_valid_window(wm, window_id))
+    return 0;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  return glps_egl_get_buffer_age(wm, window_id);
+#else
+  return 0;
+#endif
+}
+
 void glps_wm_window_set_resize_callback(
     glps_WindowManager *wm,
     void (*window_resize_callback)(size_t window_id, int width, int height,
@@ -330,6 +538,178 @@ void glps_wm_window_set_frame_update_callback(
   wm->callbacks.window_frame_update_data = data;
 }
 
+void glps_wm_window_set_present_callback(
+    glps_WindowManager *wm,
+    void (*window_present_callback)(size_t window_id,
+                                    const glps_PresentFeedback *feedback,
+                                    void *data),
+    void *data)
+{
+  if (wm == NULL || window_present_callback == NULL)
+  {
+    LOG_CRITICAL("Window Manager and/or Callback function NULL.");
+    return;
+  }
+
+  wm->callbacks.window_present_callback = window_present_callback;
+  wm->callbacks.window_present_data = data;
+}
+
+void glps_wm_window_set_visibility_callback(
+    glps_WindowManager *wm,
+    void (*window_visibility_callback)(size_t window_id, GLPS_VISIBILITY visibility,
+                                       void *data),
+    void *data)
+{
+  if (wm == NULL)
+  {
+    LOG_ERROR("Window Manager is NULL.");
+    return;
+  }
+
+  wm->callbacks.window_visibility_callback = window_visibility_callback;
+  wm->callbacks.window_visibility_data = data;
+}
+
+GLPS_VISIBILITY glps_wm_window_get_visibility(glps_WindowManager *wm, size_t window_id)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (__is_valid_window(wm, window_id))
+    return wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule.visibility;
+#else
+  (void)wm;
+  (void)window_id;
+#endif
+  return GLPS_VISIBILITY_VISIBLE;
+}
+
+void glps_wm_window_set_hidden_fps(glps_WindowManager *wm, size_t window_id, double fps)
+{
+  if (!__is_valid_window(wm, window_id))
+    return;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule.hidden_fps = fps > 0.0 ? fps : 0.0;
+#else
+  (void)fps;
+  LOG_WARNING("Visibility throttling is not supported on this platform.");
+#endif
+}
+
+bool glps_wm_window_get_present_feedback(glps_WindowManager *wm, size_t window_id,
+                                         glps_PresentFeedback *feedback)
+{
+  if (feedback == NULL || !__is_valid_window(wm, window_id))
+    return false;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  *feedback = wm->windows[GLPS_WINDOW_SLOT(window_id)]->last_present;
+  return feedback->present_ns != 0;
+#else
+  return false;
+#endif
+}
+
+void glps_wm_window_set_target_fps(glps_WindowManager *wm, size_t window_id, double fps)
+{
+  if (!__is_valid_window(wm, window_id))
+    return;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_scheduler_set_target(&wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule, fps);
+#else
+  (void)fps;
+  LOG_WARNING("Per-window frame rates are not supported on this platform.");
+#endif
+}
+
+void glps_wm_window_set_render_mode(glps_WindowManager *wm, size_t window_id,
+                                   GLPS_RENDER_MODE mode)
+{
+  if (!__is_valid_window(wm, window_id))
+    return;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_FrameSchedule *schedule = &wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule;
+  schedule->render_mode = mode;
+  // The first on-demand frame shows whatever changed while switching.
+  schedule->redraw_pending = mode == GLPS_RENDER_ON_DEMAND;
+  schedule->redraw_at_ns = 0;
+#else
+  if (mode != GLPS_RENDER_CONTINUOUS)
+    LOG_WARNING("On-demand rendering is not supported on this platform.");
+#endif
+}
+
+void glps_wm_request_redraw(glps_WindowManager *wm, size_t window_id)
+{
+  if (!__is_valid_window(wm, window_id))
+    return;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_scheduler_request_redraw(&wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule);
+#endif
+}
+
+void glps_wm_request_redraw_after(glps_WindowManager *wm, size_t window_id, uint64_t delay_ns)
+{
+  if (!__is_valid_window(wm, window_id))
+    return;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_FrameSchedule *schedule = &wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule;
+  uint64_t redraw_at = glps_latency_now_ns() + delay_ns;
+  if (schedule->redraw_at_ns == 0 || redraw_at < schedule->redraw_at_ns)
+    schedule->redraw_at_ns = redraw_at;
+#else
+  (void)delay_ns;
+#endif
+}
+
+bool glps_wm_window_get_frame_stats(glps_WindowManager *wm, size_t window_id,
+                                    glps_FrameStats *stats)
+{
+  if (stats == NULL || !__is_valid_window(wm, window_id))
+    return false;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  *stats = wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule.stats;
+  return true;
+#else
+  *stats = (glps_FrameStats){0};
+  return false;
+#endif
+}
+
+bool glps_wm_frame_begin(glps_WindowManager *wm, size_t window_id, glps_FrameDeadline *deadline)
+{
+  if (deadline == NULL || !__is_valid_window(wm, window_id))
+    return false;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_scheduler_begin_render(&wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule,
+                              wm->windows[GLPS_WINDOW_SLOT(window_id)]->last_present.present_ns,
+                              deadline);
+  return true;
+#else
+  *deadline = (glps_FrameDeadline){0};
+  return false;
+#endif
+}
+
+double glps_wm_window_get_refresh_rate(glps_WindowManager *wm, size_t window_id)
+{
+  if (!__is_valid_window(wm, window_id))
+    return 0.0;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  uint64_t refresh_ns = wm->windows[GLPS_WINDOW_SLOT(window_id)]->schedule.refresh_ns;
+  return refresh_ns != 0 ? 1e9 / (double)refresh_ns : 0.0;
+#else
+  return 0.0;
+#endif
+}
+
 void glps_wm_window_set_close_callback(
     glps_WindowManager *wm,
     void (*window_close_callback)(size_t window_id, void *data), void *data)
@@ -345,35 +725,113 @@ void glps_wm_window_set_close_callback(
   wm->callbacks.window_close_data = data;
 }
 
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+static bool __headless_requested(void)
+{
+  const char *value = getenv("GLPS_HEADLESS");
+  return value != NULL && value[0] != '\0' && strcmp(value, "0") != 0;
+}
+
+static bool __display_init(glps_WindowManager *wm)
+{
+#ifdef GLPS_USE_WAYLAND
+  if (!glps_wl_init(wm))
+  {
+    LOG_WARNING("Wayland init failed.");
+    return false;
+  }
+  if (!glps_egl_init(wm, wm->wayland_ctx->wl_display))
+  {
+    LOG_WARNING("EGL init on the Wayland display failed.");
+    glps_wl_destroy(wm);
+    return false;
+  }
+#else
+  if (!glps_x11_init(wm))
+  {
+    LOG_WARNING("X11 init failed.");
+    return false;
+  }
+  if (!glps_egl_init(wm, wm->x11_ctx->display))
+  {
+    LOG_WARNING("EGL init on the X11 display failed.");
+    glps_x11_destroy(wm);
+    return false;
+  }
+#endif
+  return true;
+}
+#endif
+
 glps_WindowManager *glps_wm_init(void)
 {
 
   glps_WindowManager *wm = malloc(sizeof(glps_WindowManager));
-  *wm = (glps_WindowManager){0};
   if (!wm)
   {
     LOG_ERROR("Failed to allocate memory for glps_WindowManager");
     return NULL;
   }
-#ifdef GLPS_USE_WAYLAND
-  if (!glps_wl_init(wm))
+  *wm = (glps_WindowManager){0};
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_thread_mutex_init(&wm->shared_lock, NULL);
+
+  // Without a reachable display server, or without EGL on it, render
+  // offscreen instead of exiting.
+  if ((__headless_requested() || !__display_init(wm)) && !glps_headless_init(wm))
   {
-    LOG_ERROR("Wayland init failed. exiting...");
+    LOG_ERROR("No display server and no headless EGL platform. exiting...");
     exit(EXIT_FAILURE);
   }
-  glps_egl_init(wm, wm->wayland_ctx->wl_display);
 
+  if (!glps_wakeup_init(wm))
+    LOG_WARNING("glps_wm_post_wakeup() will not interrupt glps_wm_wait_events().");
 #elif defined(GLPS_USE_WIN32)
   glps_win32_init(wm);
-#elif defined(GLPS_USE_X11)
-  glps_x11_init(wm);
-  glps_egl_init(wm, wm->x11_ctx->display);
-
 #endif
 
   return wm;
 }
 
+glps_WindowManager *glps_wm_init_headless(void)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_WindowManager *wm = malloc(sizeof(glps_WindowManager));
+  if (!wm)
+  {
+    LOG_ERROR("Failed to allocate memory for glps_WindowManager");
+    return NULL;
+  }
+  *wm = (glps_WindowManager){0};
+  glps_thread_mutex_init(&wm->shared_lock, NULL);
+
+  if (!glps_headless_init(wm))
+  {
+    glps_thread_mutex_destroy(&wm->shared_lock);
+    free(wm);
+    return NULL;
+  }
+
+  if (!glps_wakeup_init(wm))
+    LOG_WARNING("glps_wm_post_wakeup() will not interrupt glps_wm_wait_events().");
+  return wm;
+#else
+  LOG_ERROR("Headless rendering is not supported on this platform.");
+  return NULL;
+#endif
+}
+
+bool glps_wm_is_headless(glps_WindowManager *wm)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  return wm != NULL && wm->headless;
+#else
+  (void)wm;
+  return false;
+#endif
+}
+
 void glps_wm_set_window_ctx_curr(glps_WindowManager *wm, size_t window_id)
 {
 #if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
@@ -394,8 +852,23 @@ void glps_wm_window_get_dimensions(glps_WindowManager *wm, size_t window_id,
     LOG_ERROR("Couldn't get window dimensions. Window Manager NULL. ");
     return;
   }
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm->headless)
+  {
+    if (!__is_valid_window(wm, window_id))
+      return;
+    *width = wm->windows[GLPS_WINDOW_SLOT(window_id)]->resize.width;
+    *height = wm->windows[GLPS_WINDOW_SLOT(window_id)]->resize.height;
+    return;
+  }
+#endif
 #if defined(GLPS_USE_WAYLAND)
-  glps_WaylandWindow *window = (glps_WaylandWindow *)wm->windows[window_id];
+  if (!__is_valid_window(wm, window_id))
+  {
+    LOG_ERROR("Couldn't get window dimensions. Invalid window ID.");
+    return;
+  }
+  glps_WaylandWindow *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
 
   *width = window->properties.width;
   *height = window->properties.height;
@@ -435,7 +908,9 @@ uint8_t glps_wm_get_platform(void)
 void *glps_wm_window_get_native_ptr(glps_WindowManager *wm, size_t window_id)
 {
 #ifdef GLPS_USE_X11
-  return (void *)(uintptr_t)wm->windows[window_id]->window;
+  if (!__is_valid_window(wm, window_id))
+    return NULL;
+  return (void *)(uintptr_t)wm->windows[GLPS_WINDOW_SLOT(window_id)]->window;
 #endif
 #ifdef GLPS_USE_WIN32
   return (void *)(uintptr_t)wm->windows[window_id]->hwnd;
@@ -449,6 +924,11 @@ size_t glps_wm_window_create(glps_WindowManager *wm, const char *title,
 {
 
   ssize_t window_id;
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm->headless)
+    return glps_headless_window_create(wm, title, width, height, NULL);
+#endif
+
 #ifdef GLPS_USE_WAYLAND
   window_id = glps_wl_window_create(wm, title, x, y, width, height);
 #endif
@@ -468,14 +948,68 @@ size_t glps_wm_window_create(glps_WindowManager *wm, const char *title,
   return window_id;
 }
 
+ssize_t glps_wm_window_create_ex(glps_WindowManager *wm, const char *title,
+                                 int x, int y, int width, int height,
+                                 GLPS_WindowFlags flags, const glps_SurfaceConfig *config)
+{
+  glps_SurfaceConfig format;
+  if ((flags & GLPS_WINDOW_TRANSPARENT) && (config == NULL || config->alpha_bits == 0))
+  {
+    // Blending with the desktop needs an alpha channel.
+    format = config != NULL ? *config : GLPS_SURFACE_CONFIG_DEFAULT;
+    format.alpha_bits = 8;
+    config = &format;
+  }
+
+  ssize_t window_id;
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm->headless)
+    return glps_headless_window_create(wm, title, width, height, config);
+#endif
+
+#ifdef GLPS_USE_WAYLAND
+  window_id = glps_wl_window_create_ex(wm, title, x, y, width, height, config);
+#endif
+
+#ifdef GLPS_USE_WIN32
+  if (config != NULL)
+    LOG_WARNING("Surface configs are not supported on this platform.");
+  window_id = glps_win32_window_create(wm, x, y, title, width, height);
+#endif
+
+#ifdef GLPS_USE_X11
+  window_id = glps_x11_window_create_ex(wm, title, x, y, width, height, flags, config);
+#endif
+
+  if (window_id < 0)
+  {
+    LOG_ERROR("Window creation failed.");
+    return window_id;
+  }
+
+  if (flags & GLPS_WINDOW_FRAMELESS)
+    glps_wm_toggle_window_decorations(wm, false, (size_t)window_id);
+  if (flags & GLPS_WINDOW_TRANSPARENT)
+    glps_wm_set_window_background_transparent(wm, (size_t)window_id);
+
+  return window_id;
+}
+
 void glps_wm_window_destroy(glps_WindowManager *wm, size_t window_id)
 {
-  if (wm == NULL || window_id >= wm->window_count ||
-      wm->windows[window_id] == NULL)
+  if (wm == NULL || !__is_valid_window(wm, window_id))
   {
     LOG_ERROR("Invalid window ID or window manager is NULL.");
     return;
   }
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm->headless)
+  {
+    glps_headless_window_destroy(wm, window_id);
+    return;
+  }
+#endif
+
 #ifdef GLPS_USE_WAYLAND
   glps_wl_window_destroy(wm, window_id);
 #endif
@@ -483,10 +1017,108 @@ void glps_wm_window_destroy(glps_WindowManager *wm, size_t window_id)
 #ifdef GLPS_USE_WIN32
 
 #endif
+
+#ifdef GLPS_USE_X11
+  glps_x11_window_destroy(wm, window_id);
+#endif
+}
+
+bool glps_wm_start_input_thread(glps_WindowManager *wm, size_t capacity)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm == NULL || capacity == 0)
+  {
+    LOG_CRITICAL("Window Manager NULL and/or capacity 0.");
+    return false;
+  }
+  if (wm->headless)
+  {
+    LOG_WARNING("There is no input to read without a display server.");
+    return false;
+  }
+
+  return glps_input_thread_start(wm, capacity);
+#else
+  (void)wm;
+  (void)capacity;
+  LOG_WARNING("Input thread is not supported on this platform.");
+  return false;
+#endif
+}
+
+void glps_wm_stop_input_thread(glps_WindowManager *wm)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_input_thread_stop(wm);
+#else
+  (void)wm;
+#endif
+}
+
+bool glps_wm_enable_event_queue(glps_WindowManager *wm, size_t capacity)
+{
+  if (wm == NULL)
+  {
+    LOG_CRITICAL("Window Manager NULL.");
+    return false;
+  }
+
+  bool enabled = glps_events_queue_init(wm, capacity);
+  __update_input_interest(wm);
+  return enabled;
+}
+
+size_t glps_wm_poll_events(glps_WindowManager *wm, glps_Event *events, size_t max_events)
+{
+  return glps_events_queue_pop(wm, events, max_events);
+}
+
+void glps_wm_get_event_stats(glps_WindowManager *wm, glps_EventStats *stats)
+{
+  if (wm == NULL || stats == NULL)
+    return;
+
+  *stats = wm->event_stats;
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  stats->input_overflows += glps_input_thread_overflows(wm);
+#endif
+}
+
+uint64_t glps_wm_get_event_timestamp(glps_WindowManager *wm)
+{
+  return wm != NULL ? glps_events_current_timestamp() : 0;
+}
+
+bool glps_wm_get_latency_histogram(glps_WindowManager *wm, size_t window_id,
+                                   glps_LatencyHistogram *histogram)
+{
+  if (histogram == NULL || !__is_valid_window(wm, window_id))
+    return false;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  *histogram = wm->windows[GLPS_WINDOW_SLOT(window_id)]->latency.histogram;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void glps_wm_reset_latency_histogram(glps_WindowManager *wm, size_t window_id)
+{
+  if (!__is_valid_window(wm, window_id))
+    return;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  wm->windows[GLPS_WINDOW_SLOT(window_id)]->latency = (glps_LatencyProbe){0};
+#endif
 }
 
 double glps_wm_get_fps(glps_WindowManager *wm, size_t window_id)
 {
+  if (!__is_valid_window(wm, window_id))
+    return -1.0f;
+
+  window_id = GLPS_WINDOW_SLOT(window_id);
   if (!wm->windows[window_id]->fps_is_init)
   {
 #if defined(GLPS_USE_WAYLAND) || defined(GPLPS_USE_X11)
@@ -536,6 +1168,10 @@ double glps_wm_get_fps(glps_WindowManager *wm, size_t window_id)
 
 bool glps_wm_should_close(glps_WindowManager *wm)
 {
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm != NULL && wm->headless)
+    return glps_headless_should_close(wm);
+#endif
 #ifdef GLPS_USE_WAYLAND
   return glps_wl_should_close(wm);
 #endif
@@ -547,10 +1183,139 @@ bool glps_wm_should_close(glps_WindowManager *wm)
 #endif
 }
 
+bool glps_wm_wait_events(glps_WindowManager *wm, int64_t timeout_ns)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm != NULL && wm->headless)
+    return glps_headless_wait_events(wm, timeout_ns);
+#endif
+#ifdef GLPS_USE_WAYLAND
+  return glps_wl_wait_events(wm, timeout_ns);
+#endif
+#ifdef GLPS_USE_WIN32
+  (void)timeout_ns;
+  return glps_win32_should_close(wm);
+#endif
+#ifdef GLPS_USE_X11
+  return glps_x11_wait_events(wm, timeout_ns);
+#endif
+}
+
+size_t glps_wm_get_fds(glps_WindowManager *wm, int *fds, size_t max_fds)
+{
+  if (wm == NULL || fds == NULL)
+    return 0;
+
+  size_t count = 0;
+#ifdef GLPS_USE_WAYLAND
+  if (wm->wayland_ctx != NULL && wm->wayland_ctx->wl_display != NULL && count < max_fds)
+    fds[count++] = wl_display_get_fd(wm->wayland_ctx->wl_display);
+#endif
+#ifdef GLPS_USE_X11
+  // The input thread owns the connection and signals through the eventfd.
+  if (wm->x11_ctx != NULL && wm->x11_ctx->display != NULL && wm->input_thread == NULL &&
+      count < max_fds)
+    fds[count++] = ConnectionNumber(wm->x11_ctx->display);
+#endif
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm->wakeup_fd >= 0 && count < max_fds)
+    fds[count++] = wm->wakeup_fd;
+#endif
+
+  return count;
+}
+
+bool glps_wm_prepare(glps_WindowManager *wm)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  // Only the wakeup eventfd can become readable.
+  if (wm != NULL && wm->headless)
+    return true;
+#endif
+#ifdef GLPS_USE_WAYLAND
+  return glps_wl_prepare(wm);
+#elif defined(GLPS_USE_X11)
+  return glps_x11_prepare(wm);
+#else
+  (void)wm;
+  return false;
+#endif
+}
+
+int64_t glps_wm_next_timeout_ns(glps_WindowManager *wm)
+{
+#ifdef GLPS_USE_WAYLAND
+  if (wm != NULL && !wm->headless)
+    return glps_wl_next_timeout_ns(wm);
+#endif
+  (void)wm;
+  return -1;
+}
+
+bool glps_wm_dispatch_pending(glps_WindowManager *wm)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm != NULL && wm->headless)
+    return glps_headless_should_close(wm);
+#endif
+#ifdef GLPS_USE_WAYLAND
+  return glps_wl_dispatch_pending(wm);
+#elif defined(GLPS_USE_X11)
+  return glps_x11_dispatch_pending(wm);
+#else
+  return glps_win32_should_close(wm);
+#endif
+}
+
+void glps_wm_enable_window_queues(glps_WindowManager *wm, bool enable)
+{
+  if (wm == NULL)
+  {
+    LOG_CRITICAL("Window Manager NULL.");
+    return;
+  }
+
+#ifdef GLPS_USE_WAYLAND
+  glps_wl_enable_window_queues(wm, enable);
+#else
+  if (enable)
+    LOG_WARNING("Per-window event queues are only supported on Wayland.");
+#endif
+}
+
+bool glps_wm_window_dispatch(glps_WindowManager *wm, size_t window_id, int64_t timeout_ns)
+{
+#ifdef GLPS_USE_WAYLAND
+  if (wm != NULL && wm->headless)
+    return glps_headless_wait_events(wm, timeout_ns);
+  return glps_wl_window_dispatch(wm, window_id, timeout_ns);
+#else
+  (void)window_id;
+  return glps_wm_wait_events(wm, timeout_ns);
+#endif
+}
+
+void glps_wm_post_wakeup(glps_WindowManager *wm)
+{
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_wakeup_post(wm);
+#else
+  (void)wm;
+#endif
+}
+
 void glps_wm_destroy(glps_WindowManager *wm)
 {
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_input_thread_stop(wm);
+
+  if (wm != NULL && wm->headless)
+    glps_headless_destroy(wm);
+#endif
+
 #ifdef GLPS_USE_WAYLAND
-  glps_wl_destroy(wm);
+  if (wm != NULL && wm->wayland_ctx != NULL)
+    glps_wl_destroy(wm);
 #endif
 
 #ifdef GLPS_USE_WIN32
@@ -558,7 +1323,19 @@ void glps_wm_destroy(glps_WindowManager *wm)
 #endif
 
 #ifdef GLPS_USE_X11
-  glps_x11_destroy(wm);
+  if (wm != NULL && wm->x11_ctx != NULL)
+    glps_x11_destroy(wm);
+#endif
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  glps_wakeup_destroy(wm);
+#endif
+
+  glps_events_queue_destroy(wm);
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (wm != NULL)
+    glps_thread_mutex_destroy(&wm->shared_lock);
 #endif
 
   if (wm)
@@ -596,19 +1373,30 @@ void glps_wm_set_window_background_transparent(glps_WindowManager *wm, size_t wi
 
 void glps_wm_window_update(glps_WindowManager *wm, size_t window_id)
 {
-  if (wm == NULL || window_id >= wm->window_count ||
-      wm->windows[window_id] == NULL)
+  if (wm == NULL || !__is_valid_window(wm, window_id))
   {
     LOG_ERROR("Invalid window ID or window manager is NULL.");
     return;
   }
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  if (!__wait_for_redraw(wm, window_id))
+    return;
+
+  if (wm->headless)
+  {
+    glps_headless_window_update(wm, window_id);
+    return;
+  }
+#endif
+
 #ifdef GLPS_USE_WAYLAND
   wl_update(wm, window_id);
 #endif
 
 #ifdef GLPS_USE_WIN32
-  InvalidateRect(wm->windows[window_id]->hwnd, NULL, FALSE);
-  UpdateWindow(wm->windows[window_id]->hwnd);
+  InvalidateRect(wm->windows[GLPS_WINDOW_SLOT(window_id)]->hwnd, NULL, FALSE);
+  UpdateWindow(wm->windows[GLPS_WINDOW_SLOT(window_id)]->hwnd);
 #endif
 
 #ifdef GLPS_USE_X11
@@ -616,6 +1404,29 @@ void glps_wm_window_update(glps_WindowManager *wm, size_t window_id)
 #endif
 }
 
+void glps_wm_windows_update(glps_WindowManager *wm)
+{
+  if (wm == NULL)
+    return;
+
+#if defined(GLPS_USE_WAYLAND) || defined(GLPS_USE_X11)
+  // Starting with the window already current saves a context switch per pass.
+  ssize_t current = glps_egl_current_window(wm);
+  size_t first = current >= 0 ? GLPS_WINDOW_SLOT(current) : 0;
+
+  size_t capacity = glps_window_table_capacity(wm);
+  for (size_t i = 0; i < capacity && !wm->should_close; ++i)
+  {
+    ssize_t window_id = glps_window_table_id_at(wm, (first + i) % capacity);
+    if (window_id >= 0)
+      glps_wm_window_update(wm, (size_t)window_id);
+  }
+#else
+  for (size_t window_id = 0; window_id < wm->window_count; ++window_id)
+    glps_wm_window_update(wm, window_id);
+#endif
+}
+
 size_t glps_wm_get_window_count(glps_WindowManager *wm)
 {
   return wm->window_count;
@@ -624,7 +1435,8 @@ size_t glps_wm_get_window_count(glps_WindowManager *wm)
 void glps_wm_window_is_resizable(glps_WindowManager *wm, bool state, size_t window_id)
 {
 #ifdef GLPS_USE_WAYLAND
-  glps_wl_window_is_resizable(wm, state, window_id);
+  if (wm != NULL && !wm->headless)
+    glps_wl_window_is_resizable(wm, state, window_id);
 #endif
 
 #ifdef GLPS_USE_X11
@@ -656,6 +1468,8 @@ void glps_wm_cursor_change(glps_WindowManager *wm, GLPS_CURSOR_TYPE cursor_type)
 void *glps_wm_get_display(glps_WindowManager *wm)
 {
 #ifdef GLPS_USE_X11
+  if (wm == NULL || wm->x11_ctx == NULL)
+    return NULL;
   return (void *)glps_x11_get_display(wm);
 #endif
 }
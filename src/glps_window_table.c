@@ -0,0 +1,133 @@
+#include "glps_window_table.h"
+#include "utils/logger/pico_logger.h"
+
+static bool __grow(glps_WindowManager *wm)
+{
+    glps_WindowTable *table = &wm->window_table;
+    size_t new_capacity = table->capacity == 0 ? GLPS_WINDOW_TABLE_INITIAL_CAPACITY
+                                               : table->capacity * 2;
+
+    if (new_capacity > GLPS_WINDOW_SLOT_MASK + (size_t)1)
+    {
+        LOG_ERROR("Window table is full (%zu slots)", table->capacity);
+        return false;
+    }
+
+    void *windows = realloc(wm->windows, new_capacity * sizeof(*wm->windows));
+    if (windows == NULL)
+    {
+        LOG_ERROR("Failed to grow windows array");
+        return false;
+    }
+    wm->windows = windows;
+
+    uint32_t *generations = realloc(table->generations, new_capacity * sizeof(*generations));
+    if (generations == NULL)
+    {
+        LOG_ERROR("Failed to grow window generations");
+        return false;
+    }
+    table->generations = generations;
+
+    size_t *free_slots = realloc(table->free_slots, new_capacity * sizeof(*free_slots));
+    if (free_slots == NULL)
+    {
+        LOG_ERROR("Failed to grow window free list");
+        return false;
+    }
+    table->free_slots = free_slots;
+
+    // Push new slots in reverse so the lowest index is handed out first.
+    for (size_t slot = new_capacity; slot-- > table->capacity;)
+    {
+        wm->windows[slot] = NULL;
+        table->generations[slot] = 0;
+        table->free_slots[table->free_count++] = slot;
+    }
+    table->capacity = new_capacity;
+
+    return true;
+}
+
+bool glps_window_table_init(glps_WindowManager *wm)
+{
+    if (wm == NULL) return false;
+
+    wm->window_table = (glps_WindowTable){0};
+    wm->windows = NULL;
+    wm->window_count = 0;
+
+    return __grow(wm);
+}
+
+void glps_window_table_destroy(glps_WindowManager *wm)
+{
+    if (wm == NULL) return;
+
+    free(wm->windows);
+    free(wm->window_table.generations);
+    free(wm->window_table.free_slots);
+
+    wm->windows = NULL;
+    wm->window_table = (glps_WindowTable){0};
+    wm->window_count = 0;
+}
+
+ssize_t glps_window_table_insert(glps_WindowManager *wm, void *window)
+{
+    if (wm == NULL || window == NULL) return -1;
+
+    if (wm->window_table.free_count == 0 && !__grow(wm)) return -1;
+
+    glps_WindowTable *table = &wm->window_table;
+    size_t slot = table->free_slots[--table->free_count];
+
+    wm->windows[slot] = window;
+    wm->window_count++;
+
+    return (ssize_t)GLPS_WINDOW_HANDLE(slot, table->generations[slot]);
+}
+
+void glps_window_table_remove(glps_WindowManager *wm, size_t window_id)
+{
+    if (!glps_window_table_is_live(wm, window_id)) return;
+
+    glps_WindowTable *table = &wm->window_table;
+    size_t slot = GLPS_WINDOW_SLOT(window_id);
+
+    wm->windows[slot] = NULL;
+    table->generations[slot] = (uint32_t)((table->generations[slot] + 1) & GLPS_WINDOW_GENERATION_MASK);
+    table->free_slots[table->free_count++] = slot;
+    wm->window_count--;
+}
+
+bool glps_window_table_is_live(glps_WindowManager *wm, size_t window_id)
+{
+    if (wm == NULL || wm->windows == NULL) return false;
+
+    size_t slot = GLPS_WINDOW_SLOT(window_id);
+    if (slot >= wm->window_table.capacity) return false;
+    if (wm->windows[slot] == NULL) return false;
+
+    return wm->window_table.generations[slot] == GLPS_WINDOW_GENERATION(window_id);
+}
+
+void *glps_window_table_get(glps_WindowManager *wm, size_t window_id)
+{
+    if (!glps_window_table_is_live(wm, window_id)) return NULL;
+
+    return wm->windows[GLPS_WINDOW_SLOT(window_id)];
+}
+
+size_t glps_window_table_capacity(glps_WindowManager *wm)
+{
+    return wm != NULL ? wm->window_table.capacity : 0;
+}
+
+ssize_t glps_window_table_id_at(glps_WindowManager *wm, size_t slot)
+{
+    if (wm == NULL || wm->windows == NULL || slot >= wm->window_table.capacity ||
+        wm->windows[slot] == NULL) return -1;
+
+    return (ssize_t)GLPS_WINDOW_HANDLE(slot, wm->window_table.generations[slot]);
+}
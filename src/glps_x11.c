@@ -1,12 +1,32 @@
 #include "glps_x11.h"
+#include "glps_capture.h"
 #include "glps_egl_context.h"
+#include "glps_window_index.h"
+#include "glps_window_table.h"
+#include "glps_wakeup.h"
+#include "glps_events.h"
+#include "glps_input_thread.h"
+#include "glps_latency.h"
+#include "glps_scheduler.h"
 #include <X11/Xatom.h>
 #include <EGL/egl.h>
+#include <poll.h>
 #include "utils/logger/pico_logger.h"
 
-#define MAX_EVENTS_PER_FRAME 10
-#define TARGET_FPS 60
-#define NS_PER_FRAME (1000000000 / TARGET_FPS)
+#ifdef GLPS_HAVE_XPRESENT
+#include <X11/extensions/Xpresent.h>
+#endif
+
+#ifdef GLPS_HAVE_XRANDR
+#include <X11/extensions/Xrandr.h>
+#endif
+
+#ifdef GLPS_HAVE_XSYNC
+#include <X11/extensions/sync.h>
+#endif
+
+// A vblank notification this many frames late means Present is not usable.
+#define PRESENT_TIMEOUT_FRAMES 4
 
 #define XC_arrow 2
 #define XC_hand1 58
@@ -20,50 +40,369 @@ static ssize_t __get_window_id_by_xid(glps_WindowManager *wm, Window xid)
 {
     if (wm == NULL || wm->windows == NULL) return -1;
 
-    for (size_t i = 0; i < wm->window_count; ++i)
+    return glps_window_index_find(wm, (uintptr_t)xid);
+}
+
+static void __present_select(glps_WindowManager *wm, glps_X11Window *window)
+{
+#ifdef GLPS_HAVE_XPRESENT
+    if (wm->x11_ctx->present_opcode == 0) return;
+
+    window->present_eid = XPresentSelectInput(wm->x11_ctx->display, window->window,
+                                              PresentCompleteNotifyMask);
+#else
+    (void)wm;
+    (void)window;
+#endif
+}
+
+static void __handle_present_event(glps_WindowManager *wm, XEvent *event)
+{
+#ifdef GLPS_HAVE_XPRESENT
+    Display *display = wm->x11_ctx->display;
+    XGenericEventCookie *cookie = &event->xcookie;
+
+    if (wm->x11_ctx->present_opcode == 0 || cookie->extension != wm->x11_ctx->present_opcode ||
+        !XGetEventData(display, cookie)) return;
+
+    XPresentCompleteNotifyEvent *complete = (XPresentCompleteNotifyEvent *)cookie->data;
+    if (cookie->evtype == PresentCompleteNotify && complete->kind == PresentCompleteKindNotifyMSC)
     {
-        if (wm->windows[i] != NULL && wm->windows[i]->window == xid) return i;
+        ssize_t window_id = __get_window_id_by_xid(wm, complete->window);
+        glps_X11Window *window = window_id >= 0 ? glps_window_table_get(wm, (size_t)window_id) : NULL;
+        if (window != NULL)
+        {
+            // UST is CLOCK_MONOTONIC in microseconds; the refresh interval is
+            // measured between notifications since Present does not report it.
+            uint64_t ust_ns = complete->ust * 1000;
+            uint64_t refresh_ns = window->last_present.refresh_ns;
+            if (window->present_msc != 0 && complete->msc > window->present_msc && ust_ns > window->present_ust_ns)
+                refresh_ns = (ust_ns - window->present_ust_ns) / (complete->msc - window->present_msc);
+
+            if (wm->x11_ctx->monitor_count == 0)
+                glps_scheduler_set_refresh(&window->schedule, refresh_ns);
+
+            window->present_pending = false;
+            window->present_msc = complete->msc;
+            window->present_ust_ns = ust_ns;
+            window->last_present = (glps_PresentFeedback){
+                .present_ns = ust_ns,
+                .refresh_ns = refresh_ns,
+                .msc = complete->msc,
+                .flags = GLPS_PRESENT_FLAG_VSYNC | GLPS_PRESENT_FLAG_HW_CLOCK,
+            };
+            glps_events_dispatch_present(wm, (size_t)window_id, &window->last_present);
+        }
     }
 
-    return -1;
+    XFreeEventData(display, cookie);
+#else
+    (void)wm;
+    (void)event;
+#endif
 }
-void __remove_window(glps_WindowManager *wm, Window xid)
+
+#ifdef GLPS_HAVE_XPRESENT
+static Bool __is_present_event(Display *display, XEvent *event, XPointer arg)
 {
-    if (!wm || !wm->windows || wm->window_count == 0) return;
+    (void)display;
+    return event->type == GenericEvent && event->xcookie.extension == *(int *)arg;
+}
+#endif
+
+// Blocks until `step` vblanks after the window's last one or a posted wakeup,
+// leaving other events queued. Returns false if the window has to be paced
+// with the timer.
+static bool __present_wait_vblank(glps_WindowManager *wm, glps_X11Window *window, uint64_t step)
+{
+#ifdef GLPS_HAVE_XPRESENT
+    // The input thread owns the connection, so it cannot be waited on here.
+    if (window->present_eid == 0 || wm->input_thread != NULL) return false;
 
-    ssize_t window_id = __get_window_id_by_xid(wm, xid);
-    if (window_id < 0) return;
+    Display *display = wm->x11_ctx->display;
 
-    // Unbind EGL surface if currently bound
-    if (wm->egl_ctx != NULL && eglGetCurrentSurface(EGL_DRAW) == wm->windows[window_id]->egl_surface)
+    if (!window->present_pending)
     {
-        eglMakeCurrent(wm->egl_ctx->dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        // Fires at present_msc + step, or at the next vblank if that one passed.
+        XPresentNotifyMSC(display, window->window, 0,
+                          window->present_msc != 0 ? window->present_msc + step : 0, 1, 0);
+        window->present_pending = true;
+        XFlush(display);
     }
 
-    // Destroy EGL surface if valid
-    if (wm->windows[window_id]->egl_surface != EGL_NO_SURFACE && wm->egl_ctx != NULL)
+    uint64_t deadline = glps_latency_now_ns() +
+                        PRESENT_TIMEOUT_FRAMES * step * glps_scheduler_refresh_ns(&window->schedule);
+    while (window->present_pending)
     {
-        eglDestroySurface(wm->egl_ctx->dpy, wm->windows[window_id]->egl_surface);
-        wm->windows[window_id]->egl_surface = EGL_NO_SURFACE;
+        XEvent event;
+        while (XCheckIfEvent(display, &event, __is_present_event, (XPointer)&wm->x11_ctx->present_opcode))
+            __handle_present_event(wm, &event);
+        if (!window->present_pending) break;
+
+        uint64_t now = glps_latency_now_ns();
+        if (now >= deadline)
+        {
+            // Xvfb and some drivers never deliver vblank notifications.
+            LOG_WARNING("No vblank notification from Present, pacing window with a timer.");
+            window->present_eid = 0;
+            window->present_pending = false;
+            return false;
+        }
+
+        struct pollfd fds[2] = {
+            {.fd = ConnectionNumber(display), .events = POLLIN},
+            {.fd = wm->wakeup_fd, .events = POLLIN},
+        };
+        poll(fds, wm->wakeup_fd >= 0 ? 2 : 1, glps_wakeup_timeout_ms((int64_t)(deadline - now)));
+
+        // A posted wakeup ends the wait early. It is left for the event loop
+        // to drain, and the notify stays pending for the next frame.
+        if (fds[1].revents & POLLIN) break;
     }
 
-    // Destroy X11 window if valid
-    if (wm->x11_ctx && wm->x11_ctx->display && wm->windows[window_id]->window)
+    return true;
+#else
+    (void)wm;
+    (void)window;
+    (void)step;
+    return false;
+#endif
+}
+
+// Number of vblanks per frame when the target rate is a whole divisor of the
+// refresh rate, 0 if the window has to be paced with the timer instead.
+static uint64_t __present_step(const glps_FrameSchedule *schedule)
+{
+    if (schedule->target_fps == GLPS_FPS_DISPLAY) return 1;
+    if (schedule->refresh_ns == 0) return 0;
+
+    uint64_t interval = glps_scheduler_interval_ns(schedule);
+    uint64_t step = (interval + schedule->refresh_ns / 2) / schedule->refresh_ns;
+    if (step == 0) return 0;
+
+    uint64_t paced = step * schedule->refresh_ns;
+    uint64_t error = paced > interval ? paced - interval : interval - paced;
+    return error * 10 < schedule->refresh_ns ? step : 0;
+}
+
+#ifdef GLPS_HAVE_XRANDR
+static uint64_t __mode_refresh_ns(const XRRModeInfo *mode)
+{
+    if (mode->dotClock == 0 || mode->hTotal == 0 || mode->vTotal == 0) return 0;
+
+    uint64_t lines = mode->vTotal;
+    if (mode->modeFlags & RR_DoubleScan) lines *= 2;
+    if (mode->modeFlags & RR_Interlace) lines /= 2;
+
+    return (uint64_t)mode->hTotal * lines * 1000000000ull / mode->dotClock;
+}
+#endif
+
+// Reads the geometry and current mode of every active CRTC.
+static void __load_monitors(glps_WindowManager *wm)
+{
+    glps_X11Context *ctx = wm->x11_ctx;
+
+    free(ctx->monitors);
+    ctx->monitors = NULL;
+    ctx->monitor_count = 0;
+
+#ifdef GLPS_HAVE_XRANDR
+    if (ctx->randr_event_base == 0) return;
+
+    Display *display = ctx->display;
+    XRRScreenResources *resources = XRRGetScreenResourcesCurrent(display, DefaultRootWindow(display));
+    if (resources == NULL) return;
+
+    ctx->monitors = calloc((size_t)resources->ncrtc, sizeof(*ctx->monitors));
+    if (ctx->monitors == NULL && resources->ncrtc > 0)
+    {
+        LOG_ERROR("Failed to allocate monitor list");
+        XRRFreeScreenResources(resources);
+        return;
+    }
+
+    for (int i = 0; i < resources->ncrtc; ++i)
+    {
+        XRRCrtcInfo *crtc = XRRGetCrtcInfo(display, resources, resources->crtcs[i]);
+        if (crtc == NULL) continue;
+
+        if (crtc->mode != None && crtc->noutput > 0)
+        {
+            glps_X11Monitor *monitor = &ctx->monitors[ctx->monitor_count++];
+            *monitor = (glps_X11Monitor){crtc->x, crtc->y, (int)crtc->width, (int)crtc->height, 0};
+
+            for (int m = 0; m < resources->nmode; ++m)
+            {
+                if (resources->modes[m].id == crtc->mode)
+                {
+                    monitor->refresh_ns = __mode_refresh_ns(&resources->modes[m]);
+                    break;
+                }
+            }
+        }
+        XRRFreeCrtcInfo(crtc);
+    }
+
+    XRRFreeScreenResources(resources);
+#endif
+}
+
+// Picks the monitor containing the window's centre and adopts its refresh rate.
+static void __update_window_monitor(glps_WindowManager *wm, size_t window_id, int width, int height)
+{
+    glps_X11Context *ctx = wm->x11_ctx;
+    glps_X11Window *window = glps_window_table_get(wm, window_id);
+    if (window == NULL || ctx->monitor_count == 0) return;
+
+    ssize_t monitor = 0;
+    if (ctx->monitor_count > 1)
+    {
+        // ConfigureNotify coordinates are relative to the WM frame, if any.
+        int x = 0, y = 0;
+        Window child;
+        XTranslateCoordinates(ctx->display, window->window, DefaultRootWindow(ctx->display),
+                              width / 2, height / 2, &x, &y, &child);
+
+        for (size_t i = 0; i < ctx->monitor_count; ++i)
+        {
+            const glps_X11Monitor *m = &ctx->monitors[i];
+            if (x >= m->x && x < m->x + m->width && y >= m->y && y < m->y + m->height)
+            {
+                monitor = (ssize_t)i;
+                break;
+            }
+        }
+    }
+
+    if (monitor == window->monitor) return;
+
+    window->monitor = monitor;
+    glps_scheduler_set_refresh(&window->schedule, ctx->monitors[monitor].refresh_ns);
+}
+
+#ifdef GLPS_HAVE_XRANDR
+static void __update_all_monitors(glps_WindowManager *wm)
+{
+    __load_monitors(wm);
+
+    for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
+    {
+        ssize_t window_id = glps_window_table_id_at(wm, slot);
+        if (window_id < 0) continue;
+
+        XWindowAttributes attributes;
+        glps_X11Window *window = wm->windows[slot];
+        window->monitor = -1;
+        if (XGetWindowAttributes(wm->x11_ctx->display, window->window, &attributes))
+            __update_window_monitor(wm, (size_t)window_id, attributes.width, attributes.height);
+    }
+}
+#endif
+
+// Advertises WM_DELETE_WINDOW and, with XSync, _NET_WM_SYNC_REQUEST so the
+// window manager waits for a frame at the new size during live resizes.
+static void __set_wm_protocols(glps_WindowManager *wm, glps_X11Window *window)
+{
+    glps_X11Context *ctx = wm->x11_ctx;
+    Atom protocols[2] = {ctx->wm_delete_window, ctx->net_wm_sync_request};
+    int count = 1;
+
+#ifdef GLPS_HAVE_XSYNC
+    if (ctx->have_sync)
+    {
+        XSyncValue zero;
+        XSyncIntToValue(&zero, 0);
+        window->sync_counter = XSyncCreateCounter(ctx->display, zero);
+        if (window->sync_counter != None)
+        {
+            unsigned long counter = window->sync_counter;
+            XChangeProperty(ctx->display, window->window, ctx->net_wm_sync_request_counter, XA_CARDINAL,
+                            32, PropModeReplace, (unsigned char *)&counter, 1);
+            count = 2;
+        }
+    }
+#endif
+
+    XSetWMProtocols(ctx->display, window->window, protocols, count);
+}
+
+// Destroys the counter __set_wm_protocols created, on teardown and on failed creates.
+static void __destroy_sync_counter(glps_WindowManager *wm, glps_X11Window *window)
+{
+#ifdef GLPS_HAVE_XSYNC
+    if (window->sync_counter != None && wm->x11_ctx && wm->x11_ctx->display)
+        XSyncDestroyCounter(wm->x11_ctx->display, window->sync_counter);
+    window->sync_counter = None;
+#else
+    (void)wm;
+    (void)window;
+#endif
+}
+
+// Delivers the size of the newest ConfigureNotify, once per pass.
+static void __flush_resizes(glps_WindowManager *wm)
+{
+    for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
+    {
+        ssize_t window_id = glps_window_table_id_at(wm, slot);
+        if (window_id >= 0)
+            glps_events_flush_resize(wm, (size_t)window_id, &wm->windows[slot]->resize);
+    }
+}
+
+void glps_x11_after_swap(glps_WindowManager *wm, size_t window_id)
+{
+#ifdef GLPS_HAVE_XSYNC
+    glps_X11Window *window = glps_window_table_get(wm, window_id);
+    if (window == NULL || !window->sync_pending || window->resize.pending) return;
+
+    // The frame just swapped has the size the window manager asked for.
+    XSyncValue value;
+    XSyncIntsToValue(&value, (unsigned int)(window->sync_value & 0xFFFFFFFFu),
+                     (int)(window->sync_value >> 32));
+    XSyncSetCounter(wm->x11_ctx->display, window->sync_counter, value);
+    XFlush(wm->x11_ctx->display);
+    window->sync_pending = false;
+#else
+    (void)wm;
+    (void)window_id;
+#endif
+}
+
+static void __remove_window(glps_WindowManager *wm, size_t window_id)
+{
+    glps_X11Window *window = glps_window_table_get(wm, window_id);
+    if (window == NULL) return;
+
+    glps_capture_stop(wm, window_id, NULL);
+
+    // Unbind EGL surface if currently bound
+    glps_egl_release_surface(wm, window->egl_surface);
+
+    // Destroy EGL surface if valid
+    if (window->egl_surface != EGL_NO_SURFACE && wm->egl_ctx != NULL)
     {
-        XDestroyWindow(wm->x11_ctx->display, wm->windows[window_id]->window);
-        wm->windows[window_id]->window = 0;
+        eglDestroySurface(wm->egl_ctx->dpy, window->egl_surface);
+        window->egl_surface = EGL_NO_SURFACE;
     }
 
-    // Free window structure
-    free(wm->windows[window_id]);
+    glps_window_index_remove(wm, (uintptr_t)window->window);
+
+    __destroy_sync_counter(wm, window);
 
-    // Shift remaining windows in array
-    for (size_t i = window_id; i < wm->window_count - 1; i++)
+    // Destroy X11 window if valid
+    if (wm->x11_ctx && wm->x11_ctx->display && window->window)
     {
-        wm->windows[i] = wm->windows[i + 1];
+        XDestroyWindow(wm->x11_ctx->display, window->window);
+        window->window = 0;
     }
-    wm->windows[wm->window_count - 1] = NULL;
-    wm->window_count--;
+    if (wm->x11_ctx && wm->x11_ctx->display && window->colormap != None)
+        XFreeColormap(wm->x11_ctx->display, window->colormap);
+
+    // Release the slot; IDs of the other windows are unaffected
+    glps_window_table_remove(wm, window_id);
+    free(window);
 
     // Destroy EGL context if last window
     if (wm->window_count == 0 && wm->egl_ctx != NULL)
@@ -72,39 +411,43 @@ void __remove_window(glps_WindowManager *wm, Window xid)
     }
 }
 
-void glps_x11_init(glps_WindowManager *wm)
+bool glps_x11_init(glps_WindowManager *wm)
 {
     if (wm == NULL)
     {
-        LOG_CRITICAL("Window Manager is NULL. Exiting..");
-        exit(EXIT_FAILURE);
+        LOG_CRITICAL("Window Manager is NULL.");
+        return false;
     }
 
     wm->x11_ctx = (glps_X11Context *)calloc(1, sizeof(glps_X11Context));
     if (wm->x11_ctx == NULL)
     {
         LOG_CRITICAL("Failed to allocate X11 context");
-        exit(EXIT_FAILURE);
+        return false;
     }
 
-    wm->windows = (glps_X11Window **)calloc(MAX_WINDOWS, sizeof(glps_X11Window *));
-    if (wm->windows == NULL)
+    if (!glps_window_table_init(wm))
     {
         LOG_CRITICAL("Failed to allocate windows array");
         free(wm->x11_ctx);
-        exit(EXIT_FAILURE);
+        wm->x11_ctx = NULL;
+        return false;
     }
      if (!XInitThreads()) {
         fprintf(stderr, "Failed to initialize X11 threads!\n");
-        exit(EXIT_FAILURE);
+        glps_window_table_destroy(wm);
+        free(wm->x11_ctx);
+        wm->x11_ctx = NULL;
+        return false;
     }
     wm->x11_ctx->display = XOpenDisplay(NULL);
     if (!wm->x11_ctx->display)
     {
         LOG_CRITICAL("Failed to open X display");
-        free(wm->windows);
+        glps_window_table_destroy(wm);
         free(wm->x11_ctx);
-        exit(EXIT_FAILURE);
+        wm->x11_ctx = NULL;
+        return false;
     }
 
     wm->x11_ctx->font = XLoadQueryFont(wm->x11_ctx->display, "fixed");
@@ -112,19 +455,132 @@ void glps_x11_init(glps_WindowManager *wm)
     {
         LOG_CRITICAL("Failed to load system font");
         XCloseDisplay(wm->x11_ctx->display);
-        free(wm->windows);
+        glps_window_table_destroy(wm);
         free(wm->x11_ctx);
-        exit(EXIT_FAILURE);
+        wm->x11_ctx = NULL;
+        return false;
     }
 
     wm->x11_ctx->wm_delete_window = XInternAtom(wm->x11_ctx->display, "WM_DELETE_WINDOW", False);
+    wm->x11_ctx->net_wm_sync_request = XInternAtom(wm->x11_ctx->display, "_NET_WM_SYNC_REQUEST", False);
+    wm->x11_ctx->net_wm_sync_request_counter =
+        XInternAtom(wm->x11_ctx->display, "_NET_WM_SYNC_REQUEST_COUNTER", False);
+
+#ifdef GLPS_HAVE_XSYNC
+    int sync_event_base, sync_error_base, sync_major, sync_minor;
+    wm->x11_ctx->have_sync = XSyncQueryExtension(wm->x11_ctx->display, &sync_event_base, &sync_error_base) &&
+                             XSyncInitialize(wm->x11_ctx->display, &sync_major, &sync_minor);
+#endif
 
     // Initialize default cursor (arrow)
     wm->x11_ctx->cursor = XCreateFontCursor(wm->x11_ctx->display, XC_arrow);
+
+#ifdef GLPS_HAVE_XPRESENT
+    int present_event_base, present_error_base;
+    int present_major = 1, present_minor = 0;
+    if (!XPresentQueryExtension(wm->x11_ctx->display, &wm->x11_ctx->present_opcode,
+                                &present_event_base, &present_error_base) ||
+        !XPresentQueryVersion(wm->x11_ctx->display, &present_major, &present_minor))
+    {
+        LOG_INFO("Present extension unavailable, pacing frames with a timer.");
+        wm->x11_ctx->present_opcode = 0;
+    }
+#endif
+
+#ifdef GLPS_HAVE_XRANDR
+    int randr_error_base;
+    if (XRRQueryExtension(wm->x11_ctx->display, &wm->x11_ctx->randr_event_base, &randr_error_base))
+    {
+        XRRSelectInput(wm->x11_ctx->display, DefaultRootWindow(wm->x11_ctx->display),
+                       RRScreenChangeNotifyMask);
+    }
+    else
+    {
+        LOG_INFO("RandR extension unavailable, assuming a 60 Hz display.");
+        wm->x11_ctx->randr_event_base = 0;
+    }
+#endif
+    __load_monitors(wm);
+    return true;
+}
+
+// Structure and expose events are always needed; input only when observed.
+static long __input_event_mask(glps_WindowManager *wm)
+{
+    unsigned int interest = glps_events_interest(wm);
+    long mask = StructureNotifyMask | ExposureMask | VisibilityChangeMask;
+
+    if (interest & GLPS_EVENT_INTEREST_POINTER_MOTION) mask |= PointerMotionMask;
+    if (interest & GLPS_EVENT_INTEREST_POINTER_BUTTON) mask |= ButtonPressMask | ButtonReleaseMask;
+    if (interest & GLPS_EVENT_INTEREST_KEYBOARD) mask |= KeyPressMask | KeyReleaseMask;
+
+    return mask;
+}
+
+void glps_x11_update_input_mask(glps_WindowManager *wm)
+{
+    if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL) return;
+
+    long mask = __input_event_mask(wm);
+    if (mask == wm->x11_ctx->input_mask) return;
+    wm->x11_ctx->input_mask = mask;
+
+    for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
+    {
+        if (glps_window_table_id_at(wm, slot) < 0) continue;
+        XSelectInput(wm->x11_ctx->display, wm->windows[slot]->window, mask);
+    }
+    XFlush(wm->x11_ctx->display);
+}
+
+// Creates the window with the visual EGL wants for the config, so formats
+// other than the default (32-bit ARGB, for one) can back a window surface.
+static Window __create_config_window(glps_WindowManager *wm, EGLConfig egl_config,
+                                     int x, int y, int width, int height, Colormap *colormap)
+{
+    Display *display = wm->x11_ctx->display;
+    int screen = DefaultScreen(display);
+    EGLint visual_id = 0;
+
+    if (!eglGetConfigAttrib(wm->egl_ctx->dpy, egl_config, EGL_NATIVE_VISUAL_ID, &visual_id) ||
+        visual_id == 0)
+        return 0;
+
+    XVisualInfo visual_template = {.visualid = (VisualID)visual_id};
+    int num_visuals = 0;
+    XVisualInfo *visual = XGetVisualInfo(display, VisualIDMask, &visual_template, &num_visuals);
+    if (visual == NULL || num_visuals == 0)
+        return 0;
+
+    *colormap = XCreateColormap(display, RootWindow(display, screen), visual->visual, AllocNone);
+
+    XSetWindowAttributes attrs = {0};
+    attrs.colormap = *colormap;
+    attrs.background_pixel = visual->depth == 32 ? 0 : WhitePixel(display, screen);
+    attrs.border_pixel = 0;
+
+    Window window = XCreateWindow(display, RootWindow(display, screen), x, y, width, height, 1,
+                                  visual->depth, InputOutput, visual->visual,
+                                  CWColormap | CWBackPixel | CWBorderPixel, &attrs);
+    XFree(visual);
+
+    if (window == 0)
+    {
+        XFreeColormap(display, *colormap);
+        *colormap = None;
+    }
+    return window;
 }
 
 ssize_t glps_x11_window_create(glps_WindowManager *wm, const char *title,
                                int x, int y, int width, int height)
+{
+    return glps_x11_window_create_ex(wm, title, x, y, width, height, GLPS_WINDOW_NORMAL, NULL);
+}
+
+ssize_t glps_x11_window_create_ex(glps_WindowManager *wm, const char *title,
+                                  int x, int y, int width, int height,
+                                  GLPS_WindowFlags flags, const glps_SurfaceConfig *config)
 {
     if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL)
     {
@@ -132,100 +588,132 @@ ssize_t glps_x11_window_create(glps_WindowManager *wm, const char *title,
         exit(EXIT_FAILURE);
     }
 
-    if (wm->window_count >= MAX_WINDOWS)
+    int screen = DefaultScreen(wm->x11_ctx->display);
+    EGLConfig egl_config = EGL_NO_CONFIG_KHR;
+    if (wm->egl_ctx != NULL)
     {
-        LOG_ERROR("Maximum number of windows reached");
-        return -1;
+        egl_config = glps_egl_choose_config(wm, config);
+        if (egl_config == EGL_NO_CONFIG_KHR)
+            return -1;
     }
 
-    int screen = DefaultScreen(wm->x11_ctx->display);
-    wm->windows[wm->window_count] = (glps_X11Window *)calloc(1, sizeof(glps_X11Window));
-    if (wm->windows[wm->window_count] == NULL)
+    glps_X11Window *window = (glps_X11Window *)calloc(1, sizeof(glps_X11Window));
+    if (window == NULL)
     {
         LOG_ERROR("Failed to allocate window");
         return -1;
     }
-    wm->windows[wm->window_count]->fps_start_time = (struct timespec){0};
-    wm->windows[wm->window_count]->fps_is_init = false;
-
-    wm->windows[wm->window_count]->window = XCreateSimpleWindow(
-        wm->x11_ctx->display,
-        RootWindow(wm->x11_ctx->display, screen),
-        x, y, width, height, 1,
-        BlackPixel(wm->x11_ctx->display, screen),
-        WhitePixel(wm->x11_ctx->display, screen));
-
-    if (wm->windows[wm->window_count]->window == 0)
+    window->fps_start_time = (struct timespec){0};
+    window->fps_is_init = false;
+    window->monitor = -1;
+    glps_scheduler_init(&window->schedule);
+    window->present = (glps_PresentState){.swap_interval = 1};
+    window->colormap = None;
+
+    // The default format keeps the default visual, as before.
+    if ((config != NULL || (flags & GLPS_WINDOW_TRANSPARENT)) && egl_config != EGL_NO_CONFIG_KHR)
+        window->window = __create_config_window(wm, egl_config, x, y, width, height,
+                                                &window->colormap);
+    if (window->window == 0)
+        window->window = XCreateSimpleWindow(
+            wm->x11_ctx->display,
+            RootWindow(wm->x11_ctx->display, screen),
+            x, y, width, height, 1,
+            BlackPixel(wm->x11_ctx->display, screen),
+            WhitePixel(wm->x11_ctx->display, screen));
+
+    if (window->window == 0)
     {
         LOG_ERROR("Failed to create X11 window");
-        free(wm->windows[wm->window_count]);
-        wm->windows[wm->window_count] = NULL;
+        free(window);
         return -1;
     }
 
-    XSetWindowBackground(wm->x11_ctx->display, wm->windows[wm->window_count]->window, 0xFFFFFF);
+    XSetWindowBackground(wm->x11_ctx->display, window->window, 0xFFFFFF);
     XSetWindowAttributes swa;
     swa.backing_store = WhenMapped;
-    XChangeWindowAttributes(wm->x11_ctx->display, wm->windows[wm->window_count]->window, CWBackingStore, &swa);
-    XStoreName(wm->x11_ctx->display, wm->windows[wm->window_count]->window, title);
+    XChangeWindowAttributes(wm->x11_ctx->display, window->window, CWBackingStore, &swa);
+    XStoreName(wm->x11_ctx->display, window->window, title);
 
-    wm->x11_ctx->gc = XCreateGC(wm->x11_ctx->display, wm->windows[wm->window_count]->window, 0, NULL);
+    wm->x11_ctx->gc = XCreateGC(wm->x11_ctx->display, window->window, 0, NULL);
     if (wm->x11_ctx->gc == NULL)
     {
         LOG_ERROR("Failed to create graphics context");
-        XDestroyWindow(wm->x11_ctx->display, wm->windows[wm->window_count]->window);
-        free(wm->windows[wm->window_count]);
-        wm->windows[wm->window_count] = NULL;
+        XDestroyWindow(wm->x11_ctx->display, window->window);
+        if (window->colormap != None) XFreeColormap(wm->x11_ctx->display, window->colormap);
+        free(window);
         return -1;
     }
 
-    XSetWMProtocols(wm->x11_ctx->display, wm->windows[wm->window_count]->window,
-                    &wm->x11_ctx->wm_delete_window, 1);
+    window->resize = (glps_ResizeState){.width = width, .height = height};
+    __set_wm_protocols(wm, window);
 
-    long event_mask = PointerMotionMask | ButtonPressMask | ButtonReleaseMask |
-                      KeyPressMask | KeyReleaseMask | StructureNotifyMask | ExposureMask;
+    wm->x11_ctx->input_mask = __input_event_mask(wm);
 
-    int result = XSelectInput(wm->x11_ctx->display, wm->windows[wm->window_count]->window, event_mask);
+    int result = XSelectInput(wm->x11_ctx->display, window->window, wm->x11_ctx->input_mask);
     if (result == BadWindow)
     {
         LOG_ERROR("Failed to select input events");
-        XDestroyWindow(wm->x11_ctx->display, wm->windows[wm->window_count]->window);
-        free(wm->windows[wm->window_count]);
-        wm->windows[wm->window_count] = NULL;
+        __destroy_sync_counter(wm, window);
+        XDestroyWindow(wm->x11_ctx->display, window->window);
+        if (window->colormap != None) XFreeColormap(wm->x11_ctx->display, window->colormap);
+        free(window);
         return -1;
     }
 
+    if (wm->x11_ctx->cursor) XDefineCursor(wm->x11_ctx->display, window->window, wm->x11_ctx->cursor);
+    __present_select(wm, window);
+
     if (wm->egl_ctx != NULL)
     {
-        wm->windows[wm->window_count]->egl_surface =
-            eglCreateWindowSurface(wm->egl_ctx->dpy, wm->egl_ctx->conf,
-                                   (NativeWindowType)wm->windows[wm->window_count]->window, NULL);
-        if (wm->windows[wm->window_count]->egl_surface == EGL_NO_SURFACE)
+        window->egl_surface = glps_egl_create_surface(wm, egl_config, config,
+                                                      (EGLNativeWindowType)window->window);
+        if (window->egl_surface == EGL_NO_SURFACE)
         {
             LOG_ERROR("Failed to create EGL surface");
-            XDestroyWindow(wm->x11_ctx->display, wm->windows[wm->window_count]->window);
-            free(wm->windows[wm->window_count]);
-            wm->windows[wm->window_count] = NULL;
+            __destroy_sync_counter(wm, window);
+            XDestroyWindow(wm->x11_ctx->display, window->window);
+            if (window->colormap != None) XFreeColormap(wm->x11_ctx->display, window->colormap);
+            free(window);
             return -1;
         }
     }
 
-    XMapWindow(wm->x11_ctx->display, wm->windows[wm->window_count]->window);
+    bool is_first_window = wm->window_count == 0;
+
+    ssize_t window_id = glps_window_table_insert(wm, window);
+    if (window_id < 0 || !glps_window_index_add(wm, (uintptr_t)window->window, (size_t)window_id))
+    {
+        LOG_ERROR("Failed to register X11 window");
+        if (window_id >= 0) glps_window_table_remove(wm, (size_t)window_id);
+        if (window->egl_surface != EGL_NO_SURFACE && wm->egl_ctx != NULL)
+        {
+            eglDestroySurface(wm->egl_ctx->dpy, window->egl_surface);
+        }
+        __destroy_sync_counter(wm, window);
+        XDestroyWindow(wm->x11_ctx->display, window->window);
+        if (window->colormap != None) XFreeColormap(wm->x11_ctx->display, window->colormap);
+        free(window);
+        return -1;
+    }
+
+    XMapWindow(wm->x11_ctx->display, window->window);
+    __update_window_monitor(wm, (size_t)window_id, width, height);
     XFlush(wm->x11_ctx->display);
 
-    if (wm->window_count == 0)
+    if (is_first_window)
     {
         glps_egl_create_ctx(wm);
-        glps_egl_make_ctx_current(wm, 0);
+        glps_egl_make_ctx_current(wm, (size_t)window_id);
     }
 
-    return wm->window_count++;
+    return window_id;
 }
 
 void glps_x11_toggle_window_decorations(glps_WindowManager *wm, bool state, size_t window_id)
 {
     if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL ||
-        window_id >= wm->window_count || wm->windows[window_id] == NULL) return;
+        !glps_window_table_is_live(wm, window_id)) return;
 
     Atom motif_hints = XInternAtom(wm->x11_ctx->display, "_MOTIF_WM_HINTS", False);
 
@@ -247,7 +735,7 @@ void glps_x11_toggle_window_decorations(glps_WindowManager *wm, bool state, size
         hints.input_mode = 0;
         hints.status = 0;
 
-        XChangeProperty(wm->x11_ctx->display, wm->windows[window_id]->window, motif_hints, motif_hints, 32,
+        XChangeProperty(wm->x11_ctx->display, wm->windows[GLPS_WINDOW_SLOT(window_id)]->window, motif_hints, motif_hints, 32,
                         PropModeReplace, (unsigned char *)&hints, 5);
     }
 
@@ -256,7 +744,7 @@ void glps_x11_toggle_window_decorations(glps_WindowManager *wm, bool state, size
 
     if (net_wm_window_type != None && window_type != None)
     {
-        XChangeProperty(wm->x11_ctx->display, wm->windows[window_id]->window, net_wm_window_type, XA_ATOM, 32,
+        XChangeProperty(wm->x11_ctx->display, wm->windows[GLPS_WINDOW_SLOT(window_id)]->window, net_wm_window_type, XA_ATOM, 32,
                         PropModeReplace, (unsigned char *)&window_type, 1);
     }
 
@@ -264,195 +752,464 @@ void glps_x11_toggle_window_decorations(glps_WindowManager *wm, bool state, size
     XSync(wm->x11_ctx->display, False);
 }
 
-bool glps_x11_should_close(glps_WindowManager *wm)
+// Server time of input events, 0 (stamped on delivery) for everything else.
+static uint64_t __event_timestamp(glps_WindowManager *wm, const XEvent *event)
 {
-    static struct timespec last_frame = {0};
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-
-    long elapsed = (now.tv_sec - last_frame.tv_sec) * 1000000000 + (now.tv_nsec - last_frame.tv_nsec);
-    if (elapsed < NS_PER_FRAME && last_frame.tv_sec != 0)
+    switch (event->type)
     {
-        return false;
+    case MotionNotify:
+        return glps_latency_from_server_ms(wm, (uint32_t)event->xmotion.time);
+    case ButtonPress:
+    case ButtonRelease:
+        return glps_latency_from_server_ms(wm, (uint32_t)event->xbutton.time);
+    case KeyPress:
+    case KeyRelease:
+        return glps_latency_from_server_ms(wm, (uint32_t)event->xkey.time);
+    default:
+        return 0;
     }
-    last_frame = now;
+}
 
-    if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL) return true;
-    if (wm->window_count == 0) return true;
+static void __handle_event(glps_WindowManager *wm, XEvent *event)
+{
+    ssize_t window_id = __get_window_id_by_xid(wm, event->xany.window);
+    if (window_id < 0 || !glps_window_table_is_live(wm, (size_t)window_id)) return;
 
-    Display *display = wm->x11_ctx->display;
+    wm->event_stats.events_processed++;
+    uint64_t timestamp_ns = __event_timestamp(wm, event);
 
-    fd_set fds;
-    FD_ZERO(&fds);
-    FD_SET(ConnectionNumber(display), &fds);
+    switch (event->type)
+    {
+    case ClientMessage:
+        if ((Atom)event->xclient.data.l[0] == wm->x11_ctx->wm_delete_window)
+        {
+            glps_events_emit(wm, &(glps_Event){.type = GLPS_EVENT_WINDOW_CLOSE, .window_id = (size_t)window_id, .timestamp_ns = timestamp_ns});
+            __remove_window(wm, (size_t)window_id);
+        }
+        else if ((Atom)event->xclient.data.l[0] == wm->x11_ctx->net_wm_sync_request)
+        {
+            glps_X11Window *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
+            window->sync_value = ((uint64_t)(uint32_t)event->xclient.data.l[3] << 32) |
+                                 (uint32_t)event->xclient.data.l[2];
+            window->sync_pending = window->sync_counter != 0;
+        }
+        break;
+
+    case DestroyNotify:
+        glps_events_emit(wm, &(glps_Event){.type = GLPS_EVENT_WINDOW_CLOSE, .window_id = (size_t)window_id, .timestamp_ns = timestamp_ns});
+        __remove_window(wm, (size_t)window_id);
+        break;
+
+    case ConfigureNotify:
+        __update_window_monitor(wm, (size_t)window_id, event->xconfigure.width, event->xconfigure.height);
+        glps_events_queue_resize(wm, (size_t)window_id, &wm->windows[GLPS_WINDOW_SLOT(window_id)]->resize,
+                                 event->xconfigure.width, event->xconfigure.height);
+        break;
+
+    case MotionNotify:
+        glps_events_emit(wm, &(glps_Event){
+                                 .type = GLPS_EVENT_MOUSE_MOVE,
+                                 .window_id = (size_t)window_id,
+                                 .timestamp_ns = timestamp_ns,
+                                 .mouse = {event->xmotion.x, event->xmotion.y},
+                             });
+        break;
+
+    case ButtonPress:
+        if (event->xbutton.button >= 4 && event->xbutton.button <= 7)
+        {
+            // Buttons 4/5 scroll up/down, 6/7 scroll left/right.
+            bool vertical = event->xbutton.button <= 5;
+            double value = (event->xbutton.button == 4 || event->xbutton.button == 7) ? 1.0 : -1.0;
+            glps_events_emit(wm, &(glps_Event){
+                                     .type = GLPS_EVENT_MOUSE_SCROLL,
+                                     .window_id = (size_t)window_id,
+                                     .timestamp_ns = timestamp_ns,
+                                     .scroll = {
+                                         .axis = vertical ? GLPS_SCROLL_V_AXIS : GLPS_SCROLL_H_AXIS,
+                                         .source = GLPS_SCROLL_SOURCE_WHEEL,
+                                         .value = value,
+                                         .discrete = (int)value,
+                                         .is_stopped = false,
+                                     },
+                                 });
+        }
+        else
+        {
+            glps_events_emit(wm, &(glps_Event){.type = GLPS_EVENT_MOUSE_CLICK, .window_id = (size_t)window_id, .timestamp_ns = timestamp_ns, .click = {true}});
+        }
+        break;
 
-    struct timeval tv = {0, 0};
+    case ButtonRelease:
+        if (event->xbutton.button < 4)
+        {
+            glps_events_emit(wm, &(glps_Event){.type = GLPS_EVENT_MOUSE_CLICK, .window_id = (size_t)window_id, .timestamp_ns = timestamp_ns, .click = {false}});
+        }
+        break;
 
-    int ready = select(ConnectionNumber(display) + 1, &fds, NULL, NULL, &tv);
-    if (ready <= 0) return false;
+    case KeyPress:
+    case KeyRelease:
+    {
+        char buf[32] = "";
+        KeySym keysym;
+        int len = XLookupString(&event->xkey, buf, sizeof(buf) - 1, &keysym, NULL);
+        buf[len > 0 ? len : 0] = '\0';
+        KeyCode keycode = XKeysymToKeycode(wm->x11_ctx->display, keysym);
+        if (keycode != 0)
+        {
+            glps_events_emit_key(wm, (size_t)window_id, event->type == KeyPress, buf, keycode, timestamp_ns);
+        }
+        break;
+    }
 
-    XEvent event;
-    int events_processed = 0;
+    case Expose:
+        glps_events_dispatch_frame(wm, (size_t)window_id);
+        break;
+
+    // Window managers unmap minimised windows.
+    case UnmapNotify:
+        glps_events_emit_visibility(wm, (size_t)window_id, GLPS_VISIBILITY_HIDDEN, timestamp_ns);
+        break;
+
+    case MapNotify:
+        glps_events_emit_visibility(wm, (size_t)window_id, GLPS_VISIBILITY_VISIBLE, timestamp_ns);
+        break;
+
+    case VisibilityNotify:
+        glps_events_emit_visibility(wm, (size_t)window_id,
+                                    event->xvisibility.state == VisibilityFullyObscured
+                                        ? GLPS_VISIBILITY_OCCLUDED
+                                        : GLPS_VISIBILITY_VISIBLE,
+                                    timestamp_ns);
+        break;
+    }
+}
 
-    while (XPending(display) > 0 && events_processed < MAX_EVENTS_PER_FRAME)
+static bool __is_structural_event(glps_WindowManager *wm, const XEvent *event)
+{
+    switch (event->type)
     {
-        XNextEvent(display, &event);
-        events_processed++;
+    case ClientMessage:
+        return (Atom)event->xclient.data.l[0] == wm->x11_ctx->wm_delete_window;
+    case DestroyNotify:
+    case ConfigureNotify:
+        return true;
+    default:
+        return false;
+    }
+}
 
-        ssize_t window_id = __get_window_id_by_xid(wm, event.xany.window);
-        if (window_id < 0 || window_id >= (ssize_t)wm->window_count || wm->windows[window_id] == NULL) continue;
+/*
+ * Reads everything the server has sent so far into the batch buffer and
+ * coalesces it in place: runs of MotionNotify for the same window collapse to
+ * the last one, only the newest ConfigureNotify per window survives, and
+ * Expose events are dropped unless they end an expose sequence (count == 0).
+ * Returns the number of batch entries; dropped entries have type 0.
+ */
+static size_t __collect_events(glps_WindowManager *wm)
+{
+    glps_X11Context *ctx = wm->x11_ctx;
+    Display *display = ctx->display;
+
+    // With the input thread running, Xlib's queue belongs to that thread and
+    // events are taken from its ring instead.
+    bool threaded = wm->input_thread != NULL;
+    int queued = threaded ? (int)glps_input_thread_pending(wm) : XEventsQueued(display, QueuedAfterFlush);
+    if (queued <= 0) return 0;
 
-        switch (event.type)
+    if ((size_t)queued > ctx->event_batch_capacity)
+    {
+        size_t capacity = ctx->event_batch_capacity ? ctx->event_batch_capacity : 64;
+        while (capacity < (size_t)queued) capacity *= 2;
+
+        XEvent *batch = realloc(ctx->event_batch, capacity * sizeof(XEvent));
+        if (batch == NULL)
         {
-        case ClientMessage:
-            if ((Atom)event.xclient.data.l[0] == wm->x11_ctx->wm_delete_window)
-            {
-                if (wm->callbacks.window_close_callback)
-                {
-                    wm->callbacks.window_close_callback((size_t)window_id, wm->callbacks.window_close_data);
-                }
-                Window window_to_remove = event.xclient.window;
-                __remove_window(wm, window_to_remove);
-            }
-            break;
+            LOG_ERROR("Failed to grow X11 event batch");
+            if (ctx->event_batch_capacity == 0) return 0;
+            queued = (int)ctx->event_batch_capacity;
+        }
+        else
+        {
+            ctx->event_batch = batch;
+            ctx->event_batch_capacity = capacity;
+        }
+    }
 
-        case DestroyNotify:
-            if (wm->callbacks.window_close_callback)
-            {
-                wm->callbacks.window_close_callback((size_t)window_id, wm->callbacks.window_close_data);
-            }
-            Window window_to_remove = event.xdestroywindow.window;
-            __remove_window(wm, window_to_remove);
-            break;
+    ctx->drain_pass++;
+    size_t count = 0;
 
-        case ConfigureNotify:
-            if (wm->callbacks.window_resize_callback)
-            {
-                wm->callbacks.window_resize_callback((size_t)window_id, event.xconfigure.width, event.xconfigure.height, wm->callbacks.window_resize_data);
-            }
-            break;
+    for (int i = 0; i < queued; ++i)
+    {
+        XEvent *event = &ctx->event_batch[count];
+        if (threaded)
+        {
+            if (!glps_input_thread_pop(wm, event)) break;
+        }
+        else
+        {
+            XNextEvent(display, event);
+        }
 
-        case MotionNotify:
-            if (wm->callbacks.mouse_move_callback)
-            {
-                wm->callbacks.mouse_move_callback((size_t)window_id, event.xmotion.x, event.xmotion.y, wm->callbacks.mouse_move_data);
-            }
-            if (window_id < wm->window_count && wm->windows[window_id] != NULL && wm->x11_ctx->cursor)
-            {
-                XDefineCursor(wm->x11_ctx->display, wm->windows[window_id]->window, wm->x11_ctx->cursor);
-            }
-            break;
+        // Cookie data is released by the next XNextEvent, so Present
+        // notifications are handled right away instead of batched.
+        if (event->type == GenericEvent)
+        {
+            if (!threaded) __handle_present_event(wm, event);
+            continue;
+        }
 
-        case ButtonPress:
-            switch (event.xbutton.button)
-            {
-            case 4:
-                if (wm->callbacks.mouse_scroll_callback)
-                {
-                    wm->callbacks.mouse_scroll_callback((size_t)window_id, GLPS_SCROLL_V_AXIS, GLPS_SCROLL_SOURCE_WHEEL, 1.0f, 1.0f, false, wm->callbacks.mouse_scroll_data);
-                }
-                break;
-            case 5:
-                if (wm->callbacks.mouse_scroll_callback)
-                {
-                    wm->callbacks.mouse_scroll_callback((size_t)window_id, GLPS_SCROLL_V_AXIS, GLPS_SCROLL_SOURCE_WHEEL, -1.0f, -1.0f, false, wm->callbacks.mouse_scroll_data);
-                }
-                break;
-            case 6:
-                if (wm->callbacks.mouse_scroll_callback)
-                {
-                    wm->callbacks.mouse_scroll_callback((size_t)window_id, GLPS_SCROLL_H_AXIS, GLPS_SCROLL_SOURCE_WHEEL, -1.0f, -1.0f, false, wm->callbacks.mouse_scroll_data);
-                }
-                break;
-            case 7:
-                if (wm->callbacks.mouse_scroll_callback)
-                {
-                    wm->callbacks.mouse_scroll_callback((size_t)window_id, GLPS_SCROLL_H_AXIS, GLPS_SCROLL_SOURCE_WHEEL, 1.0f, 1.0f, false, wm->callbacks.mouse_scroll_data);
-                }
-                break;
-            default:
-                if (wm->callbacks.mouse_click_callback)
-                {
-                    wm->callbacks.mouse_click_callback((size_t)window_id, true, wm->callbacks.mouse_click_data);
-                }
-                break;
-            }
-            break;
+#ifdef GLPS_HAVE_XRANDR
+        if (ctx->randr_event_base != 0 && event->type == ctx->randr_event_base + RRScreenChangeNotify)
+        {
+            XRRUpdateConfiguration(event);
+            __update_all_monitors(wm);
+            continue;
+        }
+#endif
 
-        case ButtonRelease:
-            if (event.xbutton.button < 4 && wm->callbacks.mouse_click_callback)
-            {
-                wm->callbacks.mouse_click_callback((size_t)window_id, false, wm->callbacks.mouse_click_data);
-            }
-            break;
+        if (event->type == Expose && event->xexpose.count != 0)
+        {
+            wm->event_stats.events_dropped++;
+            continue;
+        }
 
-        case KeyPress:
-            if (wm->callbacks.keyboard_callback)
+        if (event->type == MotionNotify && count > 0)
+        {
+            XEvent *previous = &ctx->event_batch[count - 1];
+            if (previous->type == MotionNotify && previous->xmotion.window == event->xmotion.window)
             {
-                char buf[32];
-                KeySym keysym;
-                XLookupString(&event.xkey, buf, sizeof(buf), &keysym, NULL);
-                KeyCode keycode = XKeysymToKeycode(wm->x11_ctx->display, keysym);
-                if (keycode != 0)
-                {
-                    wm->callbacks.keyboard_callback((size_t)window_id, true, buf, keycode, wm->callbacks.keyboard_data);
-                }
+                *previous = *event;
+                wm->event_stats.events_merged++;
+                continue;
             }
-            break;
+        }
 
-        case KeyRelease:
-            if (wm->callbacks.keyboard_callback)
+        if (event->type == ConfigureNotify)
+        {
+            ssize_t window_id = __get_window_id_by_xid(wm, event->xconfigure.window);
+            glps_X11Window *window = window_id >= 0 ? glps_window_table_get(wm, (size_t)window_id) : NULL;
+            if (window != NULL)
             {
-                char buf[32];
-                KeySym keysym;
-                XLookupString(&event.xkey, buf, sizeof(buf), &keysym, NULL);
-                KeyCode keycode = XKeysymToKeycode(wm->x11_ctx->display, keysym);
-                if (keycode != 0)
+                if (window->configure_pass == ctx->drain_pass)
                 {
-                    wm->callbacks.keyboard_callback((size_t)window_id, false, buf, keycode, wm->callbacks.keyboard_data);
+                    ctx->event_batch[window->configure_index].type = 0;
+                    wm->event_stats.events_merged++;
                 }
+                window->configure_pass = ctx->drain_pass;
+                window->configure_index = count;
             }
-            break;
+        }
 
-        case Expose:
-            if (wm->callbacks.window_frame_update_callback)
-            {
-                wm->callbacks.window_frame_update_callback((size_t)window_id, wm->callbacks.window_frame_update_data);
-            }
-            break;
+        count++;
+    }
+
+    return count;
+}
+
+bool glps_x11_should_close(glps_WindowManager *wm)
+{
+    if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL) return true;
+    if (wm->window_count == 0) return true;
+
+    size_t count = __collect_events(wm);
+    XEvent *batch = wm->x11_ctx->event_batch;
+
+    // Close and resize first, so input is never delivered to a window that is
+    // already gone or at a size the application has not seen yet.
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (batch[i].type == 0 || !__is_structural_event(wm, &batch[i])) continue;
+        __handle_event(wm, &batch[i]);
+        batch[i].type = 0;
+    }
+    __flush_resizes(wm);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (batch[i].type == 0) continue;
+        __handle_event(wm, &batch[i]);
+    }
+
+    return wm->window_count == 0;
+}
+
+bool glps_x11_prepare(glps_WindowManager *wm)
+{
+    if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL) return false;
+
+    if (wm->input_thread != NULL)
+    {
+        XFlush(wm->x11_ctx->display);
+        return glps_input_thread_pending(wm) == 0;
+    }
+
+    // Events already read into Xlib's queue will not show up on the socket.
+    return XEventsQueued(wm->x11_ctx->display, QueuedAfterFlush) == 0;
+}
+
+bool glps_x11_dispatch_pending(glps_WindowManager *wm)
+{
+    if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL) return true;
+
+    glps_wakeup_drain(wm);
+
+    if (wm->input_thread == NULL && XEventsQueued(wm->x11_ctx->display, QueuedAfterReading) == 0)
+        return wm->window_count == 0;
+
+    return glps_x11_should_close(wm);
+}
+
+bool glps_x11_wait_events(glps_WindowManager *wm, int64_t timeout_ns)
+{
+    if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL) return true;
+    if (wm->window_count == 0) return true;
+
+    if (glps_x11_prepare(wm))
+    {
+        struct pollfd fds[2] = {
+            {.fd = ConnectionNumber(wm->x11_ctx->display), .events = POLLIN},
+            {.fd = wm->wakeup_fd, .events = POLLIN},
+        };
+        struct pollfd *first = fds;
+        nfds_t nfds = wm->wakeup_fd >= 0 ? 2 : 1;
+
+        // The input thread owns the connection and posts a wakeup instead.
+        if (wm->input_thread != NULL)
+        {
+            first = &fds[1];
+            nfds = 1;
         }
+
+        if (poll(first, nfds, glps_wakeup_timeout_ms(timeout_ns)) < 0 &&
+            errno != EINTR)
+            LOG_ERROR("poll on X11 connection failed: %s", strerror(errno));
     }
 
-    return false;
+    return glps_x11_dispatch_pending(wm);
 }
 
-void glps_x11_window_update(glps_WindowManager *wm, size_t window_id)
+bool glps_x11_input_thread_setup(glps_WindowManager *wm)
 {
-    if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL ||
-        window_id >= wm->window_count || wm->windows[window_id] == NULL) return;
+    struct glps_InputThread *input = wm->input_thread;
+    Display *display = wm->x11_ctx->display;
 
-    static struct timespec last_time = {0};
-    struct timespec current_time;
-    clock_gettime(CLOCK_MONOTONIC, &current_time);
+    input->stop_atom = XInternAtom(display, "_GLPS_INPUT_THREAD_STOP", False);
+    input->wake_window = XCreateSimpleWindow(display, DefaultRootWindow(display), 0, 0, 1, 1, 0, 0, 0);
+    if (input->wake_window == None)
+    {
+        LOG_ERROR("Failed to create input thread wake window");
+        return false;
+    }
 
-    if (last_time.tv_sec != 0 || last_time.tv_nsec != 0)
+    XFlush(display);
+    return true;
+}
+
+void *glps_x11_input_thread_run(void *arg)
+{
+    glps_WindowManager *wm = (glps_WindowManager *)arg;
+    struct glps_InputThread *input = wm->input_thread;
+    Display *display = wm->x11_ctx->display;
+
+    glps_input_thread_enter(wm);
+
+    while (atomic_load(&input->running))
     {
-        long elapsed_ns = (current_time.tv_sec - last_time.tv_sec) * 1000000000 + (current_time.tv_nsec - last_time.tv_nsec);
-        if (elapsed_ns < NS_PER_FRAME)
+        XEvent event;
+        XNextEvent(display, &event);
+
+        if (event.type == ClientMessage && event.xclient.window == input->wake_window)
+            continue;
+
+        // Only motion may be dropped; the drain coalesces it anyway.
+        if (!glps_input_thread_push(wm, &event, event.type == MotionNotify))
         {
-            struct timespec sleep_time = {0, NS_PER_FRAME - elapsed_ns};
-            nanosleep(&sleep_time, NULL);
+            // Stopping with a full ring: teardown puts the ring back in
+            // front of this event, keeping the order.
+            if (event.type != MotionNotify)
+            {
+                XPutBackEvent(display, &event);
+                break;
+            }
         }
+
+        // Wake the render thread once per burst rather than once per event.
+        if (XEventsQueued(display, QueuedAlready) == 0)
+            glps_wakeup_post(wm);
     }
-    last_time = current_time;
 
-    if (wm->callbacks.window_frame_update_callback)
+    return NULL;
+}
+
+void glps_x11_input_thread_wake(glps_WindowManager *wm)
+{
+    struct glps_InputThread *input = wm->input_thread;
+    Display *display = wm->x11_ctx->display;
+
+    XEvent event = {0};
+    event.xclient.type = ClientMessage;
+    event.xclient.window = input->wake_window;
+    event.xclient.message_type = input->stop_atom;
+    event.xclient.format = 32;
+
+    XSendEvent(display, input->wake_window, False, NoEventMask, &event);
+    XFlush(display);
+}
+
+void glps_x11_input_thread_teardown(glps_WindowManager *wm)
+{
+    struct glps_InputThread *input = wm->input_thread;
+    Display *display = wm->x11_ctx->display;
+
+    // Hand undelivered events back to Xlib. XPutBackEvent pushes to the front
+    // of the queue, so put them back newest first.
+    size_t pending = glps_spsc_size(&input->ring);
+    XEvent *events = pending > 0 ? malloc(pending * sizeof(XEvent)) : NULL;
+    if (events != NULL)
     {
-        wm->callbacks.window_frame_update_callback(window_id, wm->callbacks.window_frame_update_data);
+        size_t count = 0;
+        while (count < pending && glps_spsc_pop(&input->ring, &events[count])) count++;
+        while (count-- > 0) XPutBackEvent(display, &events[count]);
+        free(events);
+    }
+
+    if (input->wake_window != None)
+    {
+        XDestroyWindow(display, input->wake_window);
+        input->wake_window = None;
+    }
+    XFlush(display);
+}
+
+void glps_x11_window_update(glps_WindowManager *wm, size_t window_id)
+{
+    if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL ||
+        !glps_window_table_is_live(wm, window_id)) return;
+
+    glps_X11Window *window = wm->windows[GLPS_WINDOW_SLOT(window_id)];
+    glps_FrameSchedule *schedule = &window->schedule;
+    if (glps_scheduler_interval_ns(schedule) != 0)
+    {
+        uint64_t step = __present_step(schedule);
+        if (step != 0 && __present_wait_vblank(wm, window, step))
+            glps_scheduler_advance(schedule, glps_latency_now_ns());
+        else
+            glps_scheduler_wait(schedule);
     }
 
+    glps_events_dispatch_frame(wm, window_id);
+
     XFlush(wm->x11_ctx->display);
 }
+
+void glps_x11_window_destroy(glps_WindowManager *wm, size_t window_id)
+{
+    if (wm == NULL || !glps_window_table_is_live(wm, window_id)) return;
+
+    __remove_window(wm, window_id);
+}
+
 void glps_x11_destroy(glps_WindowManager *wm)
 {
     if (!wm) return;
@@ -460,13 +1217,14 @@ void glps_x11_destroy(glps_WindowManager *wm)
     // Remove all windows safely
     if (wm->windows)
     {
-        while (wm->window_count > 0)
+        for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
         {
-            __remove_window(wm, wm->windows[0]->window);
+            ssize_t window_id = glps_window_table_id_at(wm, slot);
+            if (window_id >= 0) __remove_window(wm, (size_t)window_id);
         }
-        free(wm->windows);
-        wm->windows = NULL;
+        glps_window_table_destroy(wm);
     }
+    glps_window_index_clear(wm);
 
     // Clean up X11 resources
     if (wm->x11_ctx)
@@ -493,6 +1251,8 @@ void glps_x11_destroy(glps_WindowManager *wm)
         }
 
         wm->x11_ctx->wm_delete_window = None;
+        free(wm->x11_ctx->event_batch);
+        free(wm->x11_ctx->monitors);
         free(wm->x11_ctx);
         wm->x11_ctx = NULL;
     }
@@ -506,13 +1266,13 @@ void glps_x11_get_window_dimensions(glps_WindowManager *wm, size_t window_id,
                                     int *width, int *height)
 {
     if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL ||
-        window_id >= wm->window_count || wm->windows[window_id] == NULL ||
+        !glps_window_table_is_live(wm, window_id) ||
         width == NULL || height == NULL) return;
 
     Window root;
     int x, y;
     unsigned int border_width, depth;
-    XGetGeometry(wm->x11_ctx->display, wm->windows[window_id]->window, &root,
+    XGetGeometry(wm->x11_ctx->display, wm->windows[GLPS_WINDOW_SLOT(window_id)]->window, &root,
                  &x, &y, (unsigned int *)width, (unsigned int *)height,
                  &border_width, &depth);
 }
@@ -520,10 +1280,10 @@ void glps_x11_get_window_dimensions(glps_WindowManager *wm, size_t window_id,
 void glps_x11_window_is_resizable(glps_WindowManager *wm, bool state, size_t window_id)
 {
     if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL ||
-        window_id >= wm->window_count || wm->windows[window_id] == NULL) return;
+        !glps_window_table_is_live(wm, window_id)) return;
 
     Display *display = wm->x11_ctx->display;
-    Window win = wm->windows[window_id]->window;
+    Window win = wm->windows[GLPS_WINDOW_SLOT(window_id)]->window;
 
     Window root;
     int x, y;
@@ -600,14 +1360,22 @@ void glps_x11_cursor_change(glps_WindowManager *wm, GLPS_CURSOR_TYPE user_cursor
     }
 
     wm->x11_ctx->cursor = XCreateFontCursor(wm->x11_ctx->display, (unsigned int)selected_cursor);
+
+    // Defined up front, since motion events may not be selected.
+    for (size_t slot = 0; slot < glps_window_table_capacity(wm); ++slot)
+    {
+        if (glps_window_table_id_at(wm, slot) < 0) continue;
+        XDefineCursor(wm->x11_ctx->display, wm->windows[slot]->window, wm->x11_ctx->cursor);
+    }
+    XFlush(wm->x11_ctx->display);
 }
 
 void glps_x11_set_window_blur(glps_WindowManager *wm, size_t window_id, bool enable, int blur_radius)
 {
-    if (wm == NULL || wm->x11_ctx == NULL || window_id >= wm->window_count) return;
+    if (wm == NULL || wm->x11_ctx == NULL || !glps_window_table_is_live(wm, window_id)) return;
 
     Display *display = wm->x11_ctx->display;
-    Window window = wm->windows[window_id]->window;
+    Window window = wm->windows[GLPS_WINDOW_SLOT(window_id)]->window;
 
     Atom atom_blur = XInternAtom(display, "_KDE_NET_WM_BLUR_BEHIND_REGION", False);
     if (atom_blur != None)
@@ -649,10 +1417,10 @@ void glps_x11_set_window_blur(glps_WindowManager *wm, size_t window_id, bool ena
 
 void glps_x11_set_window_opacity(glps_WindowManager *wm, size_t window_id, float opacity)
 {
-    if (wm == NULL || wm->x11_ctx == NULL || window_id >= wm->window_count) return;
+    if (wm == NULL || wm->x11_ctx == NULL || !glps_window_table_is_live(wm, window_id)) return;
 
     Display *display = wm->x11_ctx->display;
-    Window window = wm->windows[window_id]->window;
+    Window window = wm->windows[GLPS_WINDOW_SLOT(window_id)]->window;
 
     Atom atom_opacity = XInternAtom(display, "_NET_WM_WINDOW_OPACITY", False);
     if (atom_opacity != None)
@@ -669,10 +1437,10 @@ void glps_x11_set_window_opacity(glps_WindowManager *wm, size_t window_id, float
 
 void glps_x11_set_window_background_transparent(glps_WindowManager *wm, size_t window_id)
 {
-    if (wm == NULL || wm->x11_ctx == NULL || window_id >= wm->window_count) return;
+    if (wm == NULL || wm->x11_ctx == NULL || !glps_window_table_is_live(wm, window_id)) return;
 
     Display *display = wm->x11_ctx->display;
-    Window window = wm->windows[window_id]->window;
+    Window window = wm->windows[GLPS_WINDOW_SLOT(window_id)]->window;
 
     XWindowAttributes window_attrs;
     if (!XGetWindowAttributes(display, window, &window_attrs)) return;
@@ -699,15 +1467,20 @@ bool glps_x11_create_window_with_visual(glps_WindowManager *wm, const char *titl
                                         int width, int height, bool transparent)
 {
     if (wm == NULL || wm->x11_ctx == NULL || wm->x11_ctx->display == NULL) return false;
-    if (wm->window_count >= MAX_WINDOWS)
-    {
-        LOG_ERROR("Maximum number of windows reached");
-        return false;
-    }
 
     Display *display = wm->x11_ctx->display;
     int screen = DefaultScreen(display);
 
+    // The window's own config; wm->egl_ctx->conf may be another window's.
+    glps_SurfaceConfig format = GLPS_SURFACE_CONFIG_DEFAULT;
+    if (transparent) format.alpha_bits = 8;
+    EGLConfig egl_config = EGL_NO_CONFIG_KHR;
+    if (wm->egl_ctx != NULL)
+    {
+        egl_config = glps_egl_choose_config(wm, &format);
+        if (egl_config == EGL_NO_CONFIG_KHR) return false;
+    }
+
     XVisualInfo visual_template;
     visual_template.depth = 32;
     visual_template.class = TrueColor;
@@ -730,6 +1503,7 @@ bool glps_x11_create_window_with_visual(glps_WindowManager *wm, const char *titl
     {
         visual = DefaultVisual(display, screen);
         depth = DefaultDepth(display, screen);
+        if (visual_list != NULL) XFree(visual_list);
         colormap = DefaultColormap(display, screen);
         if (transparent) LOG_WARNING("Transparent window requested but no 32-bit visual available");
     }
@@ -738,7 +1512,8 @@ bool glps_x11_create_window_with_visual(glps_WindowManager *wm, const char *titl
     attrs.colormap = colormap;
     attrs.background_pixmap = None;
     attrs.border_pixel = 0;
-    attrs.event_mask = PointerMotionMask | ButtonPressMask | ButtonReleaseMask | KeyPressMask | KeyReleaseMask | StructureNotifyMask | ExposureMask;
+    wm->x11_ctx->input_mask = __input_event_mask(wm);
+    attrs.event_mask = wm->x11_ctx->input_mask;
 
     unsigned long attrs_mask = CWColormap | CWBackPixmap | CWBorderPixel | CWEventMask;
 
@@ -763,9 +1538,8 @@ bool glps_x11_create_window_with_visual(glps_WindowManager *wm, const char *titl
         return false;
     }
 
-    size_t window_index = wm->window_count;
-    wm->windows[window_index] = calloc(1, sizeof(glps_X11Window));
-    if (wm->windows[window_index] == NULL)
+    glps_X11Window *x11_window = calloc(1, sizeof(glps_X11Window));
+    if (x11_window == NULL)
     {
         LOG_ERROR("Failed to allocate window");
         XDestroyWindow(display, window);
@@ -776,45 +1550,63 @@ bool glps_x11_create_window_with_visual(glps_WindowManager *wm, const char *titl
         return false;
     }
 
-    wm->windows[window_index]->window = window;
-    wm->windows[window_index]->fps_start_time = (struct timespec){0};
-    wm->windows[window_index]->fps_is_init = false;
+    x11_window->window = window;
+    x11_window->colormap = colormap != DefaultColormap(display, screen) ? colormap : None;
+    x11_window->fps_start_time = (struct timespec){0};
+    x11_window->fps_is_init = false;
+    x11_window->monitor = -1;
+    glps_scheduler_init(&x11_window->schedule);
+    x11_window->present = (glps_PresentState){.swap_interval = 1};
 
     XStoreName(display, window, title);
-    XSetWMProtocols(display, window, &wm->x11_ctx->wm_delete_window, 1);
+    x11_window->resize = (glps_ResizeState){.width = width, .height = height};
+    __set_wm_protocols(wm, x11_window);
+    if (wm->x11_ctx->cursor) XDefineCursor(display, window, wm->x11_ctx->cursor);
+    __present_select(wm, x11_window);
 
     if (wm->egl_ctx != NULL)
     {
-        EGLSurface egl_surface = eglCreateWindowSurface(wm->egl_ctx->dpy, wm->egl_ctx->conf, (NativeWindowType)window, NULL);
+        EGLSurface egl_surface = glps_egl_create_surface(wm, egl_config, &format, (EGLNativeWindowType)window);
         if (egl_surface == EGL_NO_SURFACE)
         {
             LOG_ERROR("Failed to create EGL surface");
+            __destroy_sync_counter(wm, x11_window);
             XDestroyWindow(display, window);
-            free(wm->windows[window_index]);
-            wm->windows[window_index] = NULL;
-            if (colormap != None && colormap != DefaultColormap(display, screen))
-            {
-                XFreeColormap(display, colormap);
-            }
+            if (x11_window->colormap != None) XFreeColormap(display, x11_window->colormap);
+            free(x11_window);
             return false;
         }
-        wm->windows[window_index]->egl_surface = egl_surface;
+        x11_window->egl_surface = egl_surface;
     }
 
-    if (window_index == 0 && wm->egl_ctx == NULL)
+    bool is_first_window = wm->window_count == 0;
+
+    ssize_t window_id = glps_window_table_insert(wm, x11_window);
+    if (window_id < 0 || !glps_window_index_add(wm, (uintptr_t)window, (size_t)window_id))
     {
-        glps_egl_create_ctx(wm);
+        LOG_ERROR("Failed to register X11 window");
+        if (window_id >= 0) glps_window_table_remove(wm, (size_t)window_id);
+        if (x11_window->egl_surface != EGL_NO_SURFACE && wm->egl_ctx != NULL)
+        {
+            eglDestroySurface(wm->egl_ctx->dpy, x11_window->egl_surface);
+        }
+        __destroy_sync_counter(wm, x11_window);
+        XDestroyWindow(display, window);
+        if (x11_window->colormap != None) XFreeColormap(display, x11_window->colormap);
+        free(x11_window);
+        return false;
     }
 
     if (wm->egl_ctx != NULL)
     {
-        glps_egl_make_ctx_current(wm, window_index);
+        if (is_first_window) glps_egl_create_ctx(wm);
+        glps_egl_make_ctx_current(wm, (size_t)window_id);
     }
 
     XMapWindow(display, window);
+    __update_window_monitor(wm, (size_t)window_id, width, height);
     XFlush(display);
 
-    wm->window_count++;
     return true;
 }
 
@@ -828,7 +1620,7 @@ Display *glps_x11_get_display(glps_WindowManager *wm)
 void glps_x11_vk_create_surface(glps_WindowManager *wm, size_t window_id, VkInstance *instance, VkSurfaceKHR *surface)
 {
     Display *xdisplay = wm->x11_ctx->display;
-    Window xwindow = wm->windows[window_id]->window;
+    Window xwindow = wm->windows[GLPS_WINDOW_SLOT(window_id)]->window;
     VkXlibSurfaceCreateInfoKHR surface_info = {
         .sType = VK_STRUCTURE_TYPE_XLIB_SURFACE_CREATE_INFO_KHR,
         .dpy = xdisplay,
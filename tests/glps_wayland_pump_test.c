@@ -0,0 +1,300 @@
+/*
+ * Wayland event pump against a live compositor (a headless weston under
+ * ctest). Covers wakeups interrupting glps_wm_wait_events(), zero timeouts
+ * that must never block, the glps_wm_prepare() / glps_wm_dispatch_pending()
+ * pairing of external loops, also while the input thread or a window queue
+ * thread holds a read intent, and a window queue read from another thread
+ * while the main thread waits. Exits 77 (skipped) without a compositor.
+ */
+
+#include "glps_window_manager.h"
+#include "glps_thread.h"
+
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SKIP 77
+#define BLOCK_LIMIT_NS 50000000ull  // A non-blocking call taking longer has blocked.
+#define WAKEUP_DELAY_NS 100000000ull
+#define WAKEUP_LIMIT_NS 2000000000ull
+
+static int failures = 0;
+
+#define CHECK(condition, ...)                   \
+    do                                          \
+    {                                           \
+        if (!(condition))                       \
+        {                                       \
+            fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);       \
+            fputc('\n', stderr);                \
+            failures++;                         \
+        }                                       \
+    } while (0)
+
+static uint64_t __now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void __sleep_ns(uint64_t ns)
+{
+    struct timespec ts = {.tv_sec = (time_t)(ns / 1000000000ull), .tv_nsec = (long)(ns % 1000000000ull)};
+    nanosleep(&ts, NULL);
+}
+
+static void *__post_wakeup_later(void *arg)
+{
+    __sleep_ns(WAKEUP_DELAY_NS);
+    glps_wm_post_wakeup((glps_WindowManager *)arg);
+    return NULL;
+}
+
+static void __test_zero_timeout(glps_WindowManager *wm)
+{
+    for (int i = 0; i < 200; ++i)
+    {
+        uint64_t start = __now_ns();
+        glps_wm_wait_events(wm, 0);
+        uint64_t elapsed = __now_ns() - start;
+        CHECK(elapsed < BLOCK_LIMIT_NS, "wait_events(0) blocked for %llu ns", (unsigned long long)elapsed);
+    }
+}
+
+static void __test_wakeup_interrupts_wait(glps_WindowManager *wm)
+{
+    gthread_t thread;
+    CHECK(glps_thread_create(&thread, NULL, __post_wakeup_later, wm) == 0, "thread create failed");
+
+    uint64_t start = __now_ns();
+    glps_wm_wait_events(wm, 10 * 1000000000ll);
+    uint64_t elapsed = __now_ns() - start;
+    glps_thread_join(thread, NULL);
+
+    CHECK(elapsed < WAKEUP_LIMIT_NS, "wakeup did not interrupt the wait (%llu ns)", (unsigned long long)elapsed);
+
+    // The wakeup was consumed, so polling afterwards must not spin on it or block.
+    start = __now_ns();
+    glps_wm_wait_events(wm, 0);
+    CHECK(__now_ns() - start < BLOCK_LIMIT_NS, "wait_events(0) blocked after a wakeup");
+}
+
+static void __test_external_loop(glps_WindowManager *wm)
+{
+    int fds[2];
+    size_t count = glps_wm_get_fds(wm, fds, 2);
+    CHECK(count == 2, "expected the display and wakeup fds, got %zu", count);
+
+    // Every prepare is paired with dispatch_pending, even when nothing is ready.
+    for (int i = 0; i < 200; ++i)
+    {
+        uint64_t start = __now_ns();
+        glps_wm_prepare(wm);
+        glps_wm_dispatch_pending(wm);
+        CHECK(__now_ns() - start < BLOCK_LIMIT_NS, "prepare/dispatch_pending blocked");
+    }
+
+    gthread_t thread;
+    CHECK(glps_thread_create(&thread, NULL, __post_wakeup_later, wm) == 0, "thread create failed");
+
+    struct pollfd pfds[2] = {{.fd = fds[0], .events = POLLIN}, {.fd = fds[1], .events = POLLIN}};
+    bool woken = false;
+    uint64_t start = __now_ns();
+    while (!woken && __now_ns() - start < WAKEUP_LIMIT_NS)
+    {
+        if (glps_wm_prepare(wm) && poll(pfds, count, 5000) > 0)
+            woken = (pfds[1].revents & POLLIN) != 0;
+        glps_wm_dispatch_pending(wm);
+    }
+    glps_thread_join(thread, NULL);
+
+    CHECK(woken, "wakeup fd never became readable");
+}
+
+static void *__write_pipe_later(void *arg)
+{
+    __sleep_ns(WAKEUP_DELAY_NS);
+    char byte = 1;
+    if (write(*(int *)arg, &byte, 1) != 1)
+        perror("write");
+    return NULL;
+}
+
+// A host loop woken by one of its own fds must get out of
+// glps_wm_dispatch_pending() while another thread holds a read intent.
+static void __run_external_loop_woken_by_pipe(glps_WindowManager *wm, const char *reader)
+{
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0)
+    {
+        CHECK(false, "pipe failed");
+        return;
+    }
+
+    int fds[2];
+    size_t count = glps_wm_get_fds(wm, fds, 2);
+
+    gthread_t thread;
+    CHECK(glps_thread_create(&thread, NULL, __write_pipe_later, &pipe_fds[1]) == 0, "thread create failed");
+
+    struct pollfd pfds[3] = {{.fd = pipe_fds[0], .events = POLLIN}};
+    for (size_t i = 0; i < count; ++i)
+        pfds[i + 1] = (struct pollfd){.fd = fds[i], .events = POLLIN};
+
+    bool woken = false;
+    uint64_t start = __now_ns();
+    while (!woken && __now_ns() - start < WAKEUP_LIMIT_NS)
+    {
+        if (glps_wm_prepare(wm) && poll(pfds, count + 1, 5000) > 0)
+            woken = (pfds[0].revents & POLLIN) != 0;
+
+        uint64_t dispatch_start = __now_ns();
+        glps_wm_dispatch_pending(wm);
+        uint64_t elapsed = __now_ns() - dispatch_start;
+        CHECK(elapsed < BLOCK_LIMIT_NS, "dispatch_pending blocked for %llu ns with the %s",
+              (unsigned long long)elapsed, reader);
+    }
+    glps_thread_join(thread, NULL);
+
+    CHECK(woken, "the loop's own fd never woke it with the %s", reader);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+static void __test_external_loop_input_thread(glps_WindowManager *wm)
+{
+    CHECK(glps_wm_start_input_thread(wm, 256), "input thread did not start");
+    __run_external_loop_woken_by_pipe(wm, "input thread");
+    glps_wm_stop_input_thread(wm);
+}
+
+struct queue_reader {
+    glps_WindowManager *wm;
+    size_t window_id;
+    uint64_t until_ns;
+    int dispatches;
+};
+
+static void *__read_window_queue(void *arg)
+{
+    struct queue_reader *reader = (struct queue_reader *)arg;
+    while (__now_ns() < reader->until_ns)
+    {
+        glps_wm_window_dispatch(reader->wm, reader->window_id, 10000000);
+        reader->dispatches++;
+    }
+    return NULL;
+}
+
+static ssize_t __create_queued_window(glps_WindowManager *wm)
+{
+    glps_wm_enable_window_queues(wm, true);
+    ssize_t window_id = glps_wm_window_create_ex(wm, "pump test", 0, 0, 64, 64,
+                                                 GLPS_WINDOW_NORMAL, NULL);
+    CHECK(window_id >= 0, "window creation failed");
+    if (window_id < 0) glps_wm_enable_window_queues(wm, false);
+    return window_id;
+}
+
+static void __destroy_queued_window(glps_WindowManager *wm, ssize_t window_id)
+{
+    glps_wm_window_destroy(wm, (size_t)window_id);
+    glps_wm_enable_window_queues(wm, false);
+}
+
+static void __test_window_queue_thread(glps_WindowManager *wm)
+{
+    ssize_t window_id = __create_queued_window(wm);
+    if (window_id < 0) return;
+
+    struct queue_reader reader = {.wm = wm, .window_id = (size_t)window_id,
+                                  .until_ns = __now_ns() + 300000000ull};
+    gthread_t thread;
+    CHECK(glps_thread_create(&thread, NULL, __read_window_queue, &reader) == 0, "thread create failed");
+
+    int waits = 0;
+    while (__now_ns() < reader.until_ns)
+    {
+        glps_wm_wait_events(wm, 10000000);
+        waits++;
+    }
+    glps_thread_join(thread, NULL);
+
+    // Both readers must keep cycling; a prepared read that is never
+    // cancelled or consumed stalls the other one.
+    CHECK(waits > 5, "main thread made only %d waits", waits);
+    CHECK(reader.dispatches > 5, "window thread made only %d dispatches", reader.dispatches);
+
+    __destroy_queued_window(wm, window_id);
+}
+
+static void __test_external_loop_window_queue(glps_WindowManager *wm)
+{
+    ssize_t window_id = __create_queued_window(wm);
+    if (window_id < 0) return;
+
+    // Outlasts the loop, so the window thread keeps re-arming its read intent.
+    struct queue_reader reader = {.wm = wm, .window_id = (size_t)window_id,
+                                  .until_ns = __now_ns() + WAKEUP_LIMIT_NS + 100000000ull};
+    gthread_t thread;
+    CHECK(glps_thread_create(&thread, NULL, __read_window_queue, &reader) == 0, "thread create failed");
+
+    __run_external_loop_woken_by_pipe(wm, "window queue thread");
+
+    glps_thread_join(thread, NULL);
+    __destroy_queued_window(wm, window_id);
+}
+
+static void __on_timeout(int signal)
+{
+    (void)signal;
+    static const char message[] = "FAIL: event pump hung\n";
+    // Nothing is left to report to if stderr is gone; exit failing anyway.
+    if (write(STDERR_FILENO, message, sizeof(message) - 1) < 0)
+        _exit(2);
+    _exit(1);
+}
+
+int main(void)
+{
+    if (getenv("WAYLAND_DISPLAY") == NULL)
+    {
+        fprintf(stderr, "WAYLAND_DISPLAY is not set, skipping.\n");
+        return SKIP;
+    }
+
+    glps_WindowManager *wm = glps_wm_init();
+    if (wm == NULL || glps_wm_is_headless(wm))
+    {
+        fprintf(stderr, "No Wayland compositor reachable, skipping.\n");
+        if (wm != NULL) glps_wm_destroy(wm);
+        return SKIP;
+    }
+
+    signal(SIGALRM, __on_timeout);
+    alarm(30);
+
+    __test_zero_timeout(wm);
+    __test_wakeup_interrupts_wait(wm);
+    __test_external_loop(wm);
+    __test_external_loop_input_thread(wm);
+    __test_window_queue_thread(wm);
+    __test_external_loop_window_queue(wm);
+
+    glps_wm_destroy(wm);
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("Wayland event pump OK\n");
+    return 0;
+}
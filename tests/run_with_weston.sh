@@ -0,0 +1,35 @@
+#!/bin/sh
+# Runs a test program against a private headless weston instance.
+# Usage: run_with_weston.sh <weston> <program> [args...]
+# Exits 77 (skipped) if weston cannot start.
+
+WESTON=$1
+shift
+
+RUNTIME_DIR=$(mktemp -d "${TMPDIR:-/tmp}/glps-weston.XXXXXX") || exit 77
+SOCKET=glps-test-$$
+
+XDG_RUNTIME_DIR=$RUNTIME_DIR "$WESTON" --backend=headless-backend.so --socket="$SOCKET" \
+    --idle-time=0 >"$RUNTIME_DIR/weston.log" 2>&1 &
+WESTON_PID=$!
+
+cleanup() {
+    kill "$WESTON_PID" 2>/dev/null
+    wait "$WESTON_PID" 2>/dev/null
+    rm -rf "$RUNTIME_DIR"
+}
+trap cleanup EXIT INT TERM
+
+# Wait up to 5 s for the socket.
+i=0
+while [ ! -S "$RUNTIME_DIR/$SOCKET" ]; do
+    if ! kill -0 "$WESTON_PID" 2>/dev/null || [ $i -ge 50 ]; then
+        echo "weston did not start, skipping:" >&2
+        cat "$RUNTIME_DIR/weston.log" >&2
+        exit 77
+    fi
+    sleep 0.1
+    i=$((i + 1))
+done
+
+XDG_RUNTIME_DIR=$RUNTIME_DIR WAYLAND_DISPLAY=$SOCKET "$@"